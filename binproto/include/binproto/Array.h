@@ -35,6 +35,10 @@ namespace binproto {
 			return array_;
 		}
 
+		const std::vector<T>& GetUnderlying() const {
+			return array_;
+		}
+
 	   private:
 		std::vector<T> array_;
 	};
@@ -44,6 +48,7 @@ namespace binproto {
 	 */
 	struct ByteArray {
 		std::vector<std::uint8_t>& GetUnderlying();
+		const std::vector<std::uint8_t>& GetUnderlying() const;
 
 		bool Read(binproto::BufferReader& reader);
 		void Write(binproto::BufferWriter& writer) const;
@@ -7,6 +7,9 @@
 
 #include <cassert>
 #include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace binproto {
 
@@ -20,23 +23,32 @@ namespace binproto {
 	 */
 	template <class T>
 	requires(Readable<T>&& Writable<T>) struct Optional {
-		Optional& operator=(const T& value) {
-			if(!has_value)
-				has_value = true;
+		Optional() = default;
+
+		Optional(const Optional& other) {
+			if(other.HasValue())
+				*this = *other.GetPtr();
+		}
+
+		Optional(Optional&& other) noexcept {
+			*this = std::move(other);
+		}
 
+		~Optional() {
+			Reset();
+		}
+
+		Optional& operator=(const T& value) {
 			// We don't do any funky stuff with
 			// the BufferWriter or anything,
 			// since this class doesn't store wire data.
 			// Only once it's been written is it wire-ivied.
+			Reset();
 
-			if constexpr(std::is_trivial_v<T>) {
-				std::memcpy(&data[0], (void*)&value, sizeof(T));
-			} else {
-				// Since the object is not trivial,
-				// we choose to invoke the copy ctor using placement new.
-				// We might be able to elide it anyways?
-				new(GetPtr()) T(value);
-			}
+			// Invoke the copy ctor using placement new;
+			// for trivial types this is just a copy anyways.
+			new(GetPtr()) T(value);
+			has_value = true;
 
 			return *this;
 		}
@@ -46,12 +58,37 @@ namespace binproto {
 			if(&other == this)
 				return *this;
 
+			Reset();
+			if(other.HasValue())
+				*this = *other.GetPtr();
+			return *this;
+		}
+
+		Optional& operator=(Optional&& other) noexcept {
+			if(&other == this)
+				return *this;
+
+			Reset();
 			if(other.HasValue()) {
-				this = *other.GetPtr();
+				new(GetPtr()) T(std::move(*other.GetPtr()));
+				has_value = true;
+				other.Reset();
 			}
 			return *this;
 		}
 
+		/**
+		 * Destroy the stored value, if there is one.
+		 */
+		void Reset() {
+			if(!has_value)
+				return;
+
+			if constexpr(!std::is_trivially_destructible_v<T>)
+				GetPtr()->~T();
+			has_value = false;
+		}
+
 		/**
 		 * Get if this Optional has a stored value
 		 */
@@ -64,6 +101,11 @@ namespace binproto {
 			return *GetPtr();
 		}
 
+		const T& Value() const {
+			assert(has_value);
+			return *GetPtr();
+		}
+
 		T* operator->() {
 			assert(has_value);
 			return GetPtr();
@@ -72,12 +114,15 @@ namespace binproto {
 		// Implementation of Readable and Writable concepts by self
 
 		bool Read(binproto::BufferReader& reader) {
-			has_value = reader.ReadByte();
+			Reset();
 
 			// doesn't have a value, so we just return true.
-			if(!has_value)
+			if(!reader.ReadByte())
 				return true;
 
+			// Construct the value before reading into it.
+			new(GetPtr()) T();
+			has_value = true;
 			return GetPtr()->Read(reader);
 		}
 
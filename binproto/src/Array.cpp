@@ -6,6 +6,10 @@ namespace binproto {
 		return data;
 	}
 
+	const std::vector<std::uint8_t>& ByteArray::GetUnderlying() const {
+		return data;
+	}
+
 	bool ByteArray::Read(binproto::BufferReader &reader) {
 		data = reader.ReadBytes();
 		return true;
@@ -0,0 +1,69 @@
+// Times every level of PixelKernels on a 1080p frame.
+//
+// Usage: narwhal-bench-pixelkernels [iterations]
+
+#include <narwhal/PixelKernels.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+	using narwhal::SimdLevel;
+
+	constexpr std::uint32_t Width = 1920;
+	constexpr std::uint32_t Height = 1080;
+	constexpr std::size_t Pixels = std::size_t { Width } * Height;
+
+	/**
+	 * Best time of a number of runs, in milliseconds.
+	 */
+	template <class Function>
+	double Time(int iterations, Function&& function) {
+		double best = 1e30;
+		for(int i = 0; i < iterations; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			function();
+			best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return best;
+	}
+} // namespace
+
+int main(int argc, char** argv) {
+	const int iterations = argc > 1 ? std::atoi(argv[1]) : 50;
+
+	std::vector<std::uint8_t> src(Pixels * 4);
+	std::mt19937 random(42);
+	for(auto& byte : src)
+		byte = static_cast<std::uint8_t>(random());
+
+	std::vector<std::uint8_t> dest(Pixels * 4);
+	std::vector<std::uint8_t> y(Pixels);
+	std::vector<std::uint8_t> u(Pixels / 4);
+	std::vector<std::uint8_t> v(Pixels / 4);
+	const narwhal::I420Planes planes { y.data(), Width, u.data(), Width / 2, v.data(), Width / 2 };
+
+	std::printf("%ux%u, best of %d, in ms\n", Width, Height, iterations);
+	std::printf("%-8s %12s %12s %12s %12s %12s\n", "", "bgrx>rgba", "rgb565>bgrx", "premultiply", "rgba>i420", "bgrx>i420");
+
+	for(auto level : { SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2 }) {
+		const auto& kernels = narwhal::GetPixelKernels(level);
+		if(kernels.level != level)
+			continue;
+
+		const auto swap = Time(iterations, [&]() { kernels.bgrx_to_rgba(src.data(), dest.data(), Pixels); });
+		const auto rgb565 = Time(iterations, [&]() { kernels.rgb565_to_bgrx(src.data(), dest.data(), Pixels); });
+		const auto premultiply = Time(iterations, [&]() { kernels.premultiply_alpha(src.data(), dest.data(), Pixels); });
+		const auto rgba_i420 = Time(iterations, [&]() { kernels.rgba_to_i420(src.data(), Width * 4, Width, Height, planes); });
+		const auto bgrx_i420 = Time(iterations, [&]() { kernels.bgrx_to_i420(src.data(), Width * 4, Width, Height, planes); });
+
+		std::printf("%-8s %12.2f %12.2f %12.2f %12.2f %12.2f\n", kernels.name, swap, rgb565, premultiply, rgba_i420, bgrx_i420);
+	}
+
+	return 0;
+}
@@ -0,0 +1,129 @@
+// Compares TimerWheel against a std::priority_queue with lazy deletion,
+// the usual alternative, on the same workload: lots of timers spread over
+// a long span, half of them cancelled before they fire, with the clock
+// moving on a tick at a time like an event loop's would.
+//
+// Usage: narwhal-bench-timerwheel [timers] [span in seconds]
+
+#include <narwhal/TimerWheel.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+
+namespace {
+	using Clock = narwhal::TimerWheel::Clock;
+
+	struct Workload {
+		std::vector<Clock::duration> deadlines;
+		std::vector<bool> cancelled;
+		Clock::duration span;
+	};
+
+	Workload MakeWorkload(std::size_t timers, std::chrono::seconds span) {
+		std::mt19937_64 random(42);
+		std::uniform_int_distribution<std::int64_t> deadline(1, std::chrono::duration_cast<std::chrono::milliseconds>(span).count());
+
+		Workload workload;
+		workload.span = span;
+		workload.deadlines.reserve(timers);
+		workload.cancelled.reserve(timers);
+		for(std::size_t i = 0; i < timers; ++i) {
+			workload.deadlines.push_back(std::chrono::milliseconds(deadline(random)));
+			workload.cancelled.push_back(i % 2 == 1);
+		}
+		return workload;
+	}
+
+	template <class Function>
+	double Time(Function&& function) {
+		const auto start = std::chrono::steady_clock::now();
+		function();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	std::size_t RunWheel(const Workload& workload, Clock::time_point origin) {
+		std::size_t fired = 0;
+		narwhal::TimerWheel wheel(std::chrono::milliseconds(1), origin);
+
+		// Timers can't be moved, so they can't live in a growing vector.
+		auto timers = std::make_unique<narwhal::Timer[]>(workload.deadlines.size());
+		for(std::size_t i = 0; i < workload.deadlines.size(); ++i) {
+			timers[i].SetCallback([&fired]() { ++fired; });
+			wheel.Schedule(timers[i], origin + workload.deadlines[i]);
+		}
+
+		for(std::size_t i = 0; i < workload.deadlines.size(); ++i) {
+			if(workload.cancelled[i])
+				timers[i].Cancel();
+		}
+
+		for(auto now = origin; now <= origin + workload.span; now += std::chrono::milliseconds(1))
+			wheel.Advance(now);
+
+		return fired;
+	}
+
+	std::size_t RunHeap(const Workload& workload, Clock::time_point origin) {
+		struct Entry {
+			Clock::time_point when;
+			std::size_t index;
+
+			bool operator>(const Entry& other) const {
+				return when > other.when;
+			}
+		};
+
+		std::size_t fired = 0;
+		std::vector<std::function<void()>> callbacks(workload.deadlines.size());
+		std::vector<bool> cancelled(workload.deadlines.size());
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<>> heap;
+
+		for(std::size_t i = 0; i < workload.deadlines.size(); ++i) {
+			callbacks[i] = [&fired]() { ++fired; };
+			heap.push({ origin + workload.deadlines[i], i });
+		}
+
+		// A heap can't take an entry out of the middle, so cancelling only marks it.
+		for(std::size_t i = 0; i < workload.deadlines.size(); ++i) {
+			if(workload.cancelled[i])
+				cancelled[i] = true;
+		}
+
+		for(auto now = origin; now <= origin + workload.span; now += std::chrono::milliseconds(1)) {
+			while(!heap.empty() && heap.top().when <= now) {
+				const auto index = heap.top().index;
+				heap.pop();
+				if(!cancelled[index])
+					callbacks[index]();
+			}
+		}
+
+		return fired;
+	}
+} // namespace
+
+int main(int argc, char** argv) {
+	const std::size_t timers = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2'000'000;
+	const std::chrono::seconds span(argc > 2 ? std::strtoll(argv[2], nullptr, 10) : 600);
+
+	const auto workload = MakeWorkload(timers, span);
+	const auto origin = Clock::now();
+
+	std::size_t wheel_fired = 0;
+	std::size_t heap_fired = 0;
+	const auto wheel_ms = Time([&]() { wheel_fired = RunWheel(workload, origin); });
+	const auto heap_ms = Time([&]() { heap_fired = RunHeap(workload, origin); });
+
+	std::printf("%zu timers over %llds, half cancelled\n", timers, static_cast<long long>(span.count()));
+	std::printf("  TimerWheel           %8.1f ms (%zu fired)\n", wheel_ms, wheel_fired);
+	std::printf("  std::priority_queue  %8.1f ms (%zu fired)\n", heap_ms, heap_fired);
+
+	return wheel_fired == heap_fired ? 0 : 1;
+}
@@ -0,0 +1,33 @@
+#ifndef NARWHAL_HASH_H
+#define NARWHAL_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace narwhal {
+
+	/**
+	 * A fast, non-cryptographic 64-bit hash (in the style of wyhash).
+	 *
+	 * Good for hash tables and content addressing. Not suitable for anything
+	 * where an attacker choosing colliding inputs matters.
+	 *
+	 * \param[in] data The data to hash.
+	 * \param[in] size Size of the data in bytes.
+	 * \param[in] seed Seed; different seeds give independent hashes.
+	 */
+	std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed = 0);
+
+	inline std::uint64_t Hash64(std::string_view string, std::uint64_t seed = 0) {
+		return Hash64(string.data(), string.size(), seed);
+	}
+
+	inline std::uint64_t Hash64(std::span<const std::uint8_t> bytes, std::uint64_t seed = 0) {
+		return Hash64(bytes.data(), bytes.size(), seed);
+	}
+
+} // namespace narwhal
+
+#endif //NARWHAL_HASH_H
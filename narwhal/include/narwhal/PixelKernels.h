@@ -0,0 +1,110 @@
+#ifndef NARWHAL_PIXELKERNELS_H
+#define NARWHAL_PIXELKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace narwhal {
+
+	/**
+	 * Instruction sets the pixel kernels come in.
+	 */
+	enum class SimdLevel : std::uint8_t {
+		Scalar,
+		Sse41,
+		Avx2
+	};
+
+	/**
+	 * Destination of an I420 (planar YUV 4:2:0) conversion.
+	 * The chroma planes are (width + 1) / 2 x (height + 1) / 2.
+	 */
+	struct I420Planes {
+		std::uint8_t* y;
+		std::size_t y_stride;
+		std::uint8_t* u;
+		std::size_t u_stride;
+		std::uint8_t* v;
+		std::size_t v_stride;
+	};
+
+	/**
+	 * Pixel format conversions, in one flavour of SIMD.
+	 *
+	 * Every level gives exactly the same bytes as the scalar one; the vector kernels
+	 * only handle the bulk of a row, and leave the ragged end to the scalar code.
+	 * Pixels are 4 bytes (BGRX, RGBA) or 2 (RGB565, little endian), and may be unaligned.
+	 */
+	struct PixelKernels {
+		const char* name;
+		SimdLevel level;
+
+		/**
+		 * BGRX => RGBA, with alpha set to 0xFF.
+		 */
+		void (*bgrx_to_rgba)(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels);
+
+		/**
+		 * RGBA => BGRX. X keeps the alpha.
+		 */
+		void (*rgba_to_bgrx)(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels);
+
+		/**
+		 * RGB565 => BGRX, widening by bit replication (so 0x1f becomes 0xff), with X set to 0xFF.
+		 */
+		void (*rgb565_to_bgrx)(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels);
+
+		/**
+		 * Multiply the colour channels of RGBA pixels by their alpha, rounding to nearest.
+		 * src and dest may be the same.
+		 */
+		void (*premultiply_alpha)(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels);
+
+		/**
+		 * RGBA or BGRX => I420, with BT.601 limited-range coefficients.
+		 * Chroma is taken from the rounded average of each 2x2 block (or of what's left of it, on odd edges).
+		 *
+		 * \param[in] src The first row of the image.
+		 * \param[in] stride Distance between rows of src, in bytes.
+		 */
+		void (*rgba_to_i420)(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const I420Planes& dest);
+		void (*bgrx_to_i420)(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const I420Planes& dest);
+	};
+
+	/**
+	 * Get the best kernels this CPU can run. Detected once.
+	 */
+	const PixelKernels& GetPixelKernels();
+
+	/**
+	 * Get the kernels of one level, or of the best level below it this CPU can run.
+	 */
+	const PixelKernels& GetPixelKernels(SimdLevel level);
+
+	inline void BgrxToRgba(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+		GetPixelKernels().bgrx_to_rgba(src, dest, pixels);
+	}
+
+	inline void RgbaToBgrx(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+		GetPixelKernels().rgba_to_bgrx(src, dest, pixels);
+	}
+
+	inline void Rgb565ToBgrx(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+		GetPixelKernels().rgb565_to_bgrx(src, dest, pixels);
+	}
+
+	inline void PremultiplyAlpha(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+		GetPixelKernels().premultiply_alpha(src, dest, pixels);
+	}
+
+	inline void RgbaToI420(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const I420Planes& dest) {
+		GetPixelKernels().rgba_to_i420(src, stride, width, height, dest);
+	}
+
+	inline void BgrxToI420(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const I420Planes& dest) {
+		GetPixelKernels().bgrx_to_i420(src, stride, width, height, dest);
+	}
+
+} // namespace narwhal
+
+#endif //NARWHAL_PIXELKERNELS_H
@@ -0,0 +1,102 @@
+#ifndef NARWHAL_RINGBUFFER_H
+#define NARWHAL_RINGBUFFER_H
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+namespace narwhal {
+
+	/**
+	 * A fixed capacity ring buffer which overwrites its oldest element when full.
+	 *
+	 * Storage is allocated once, up front. Overwritten and cleared elements are
+	 * assigned over rather than destroyed, so element types which own memory
+	 * (like std::string) keep reusing their allocations once the buffer has wrapped.
+	 *
+	 * \tparam T Element type. Must be default constructible and move assignable.
+	 */
+	template <class T>
+	struct RingBuffer {
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] capacity Maximum number of elements kept. Must not be 0.
+		 */
+		explicit RingBuffer(std::size_t capacity)
+			: elements_(new T[capacity]),
+			  capacity_(capacity) {
+			assert(capacity != 0);
+		}
+
+		RingBuffer(RingBuffer&&) noexcept = default;
+		RingBuffer& operator=(RingBuffer&&) noexcept = default;
+
+		/**
+		 * Add an element to the end of the buffer, dropping the oldest one if it's full.
+		 *
+		 * \return The slot the element was stored in, so it can be filled in place.
+		 */
+		T& Push(T value) {
+			auto& slot = NextSlot();
+			slot = std::move(value);
+			return slot;
+		}
+
+		/**
+		 * Like Push(), but hands back the (possibly previously used) slot
+		 * for the caller to overwrite in place.
+		 */
+		T& NextSlot() {
+			auto& slot = elements_[(start_ + size_) % capacity_];
+			if(size_ == capacity_)
+				start_ = (start_ + 1) % capacity_;
+			else
+				++size_;
+			return slot;
+		}
+
+		/**
+		 * Forget every element. Storage is kept.
+		 */
+		void Clear() {
+			start_ = 0;
+			size_ = 0;
+		}
+
+		/**
+		 * Get an element. 0 is the oldest, Size() - 1 the newest.
+		 */
+		T& operator[](std::size_t index) {
+			assert(index < size_);
+			return elements_[(start_ + index) % capacity_];
+		}
+
+		const T& operator[](std::size_t index) const {
+			assert(index < size_);
+			return elements_[(start_ + index) % capacity_];
+		}
+
+		[[nodiscard]] std::size_t Size() const {
+			return size_;
+		}
+
+		[[nodiscard]] std::size_t Capacity() const {
+			return capacity_;
+		}
+
+		[[nodiscard]] bool Empty() const {
+			return size_ == 0;
+		}
+
+	   private:
+		std::unique_ptr<T[]> elements_;
+		std::size_t capacity_ {};
+		std::size_t start_ {};
+		std::size_t size_ {};
+	};
+
+} // namespace narwhal
+
+#endif //NARWHAL_RINGBUFFER_H
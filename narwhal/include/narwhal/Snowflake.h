@@ -0,0 +1,92 @@
+#ifndef NARWHAL_SNOWFLAKE_H
+#define NARWHAL_SNOWFLAKE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+namespace narwhal {
+
+	/**
+	 * Layout of a snowflake ID: 64 bits which are unique across every node of a cluster
+	 * without any coordination, and sort by when they were made.
+	 *
+	 * From the top: a zero bit (so IDs stay positive as signed integers), 41 bits of
+	 * milliseconds since Epoch (good for 69 years), 10 bits of node ID, and 12 bits of
+	 * sequence within the millisecond.
+	 */
+	struct Snowflake {
+		constexpr static unsigned TimestampBits = 41;
+		constexpr static unsigned NodeBits = 10;
+		constexpr static unsigned SequenceBits = 12;
+
+		constexpr static std::uint16_t MaxNode = (1u << NodeBits) - 1;
+		constexpr static std::uint16_t MaxSequence = (1u << SequenceBits) - 1;
+
+		/**
+		 * 2021-01-01T00:00:00Z, in milliseconds since the Unix epoch.
+		 */
+		constexpr static std::uint64_t Epoch = 1609459200000;
+
+		/**
+		 * Milliseconds since the Unix epoch.
+		 */
+		std::uint64_t timestamp {};
+		std::uint16_t node {};
+		std::uint16_t sequence {};
+
+		/**
+		 * Split an ID up.
+		 */
+		[[nodiscard]] static Snowflake Split(std::uint64_t id);
+
+		/**
+		 * Put an ID together.
+		 */
+		[[nodiscard]] std::uint64_t Join() const;
+	};
+
+	/**
+	 * Makes snowflake IDs for one node.
+	 *
+	 * Next() is lock-free and can be called from any number of threads; the generator's
+	 * whole state is one atomic word (the last timestamp and sequence handed out), which
+	 * each ID advances with a compare-and-swap. If the wall clock goes back (an NTP step,
+	 * say), IDs keep counting on from the last one instead of repeating; if more than
+	 * 4096 are made in one millisecond, the next millisecond is borrowed. Either way the
+	 * generator runs a little ahead of the clock until the clock catches up.
+	 *
+	 * That only holds within one process: a node restarted while its clock is behind
+	 * where it was could repeat IDs, as could two nodes given the same node ID.
+	 * Threads that make IDs all the time can each have their own generator (and node ID)
+	 * to not share the atomic at all.
+	 */
+	struct SnowflakeGenerator {
+		using Clock = std::chrono::system_clock;
+
+		/**
+		 * Constructor. Throws std::invalid_argument if the node ID is over Snowflake::MaxNode.
+		 *
+		 * \param[in] node The node ID. Must be unique in the cluster.
+		 */
+		explicit SnowflakeGenerator(std::uint16_t node);
+
+		/**
+		 * Make an ID.
+		 */
+		[[nodiscard]] std::uint64_t Next(Clock::time_point now = Clock::now());
+
+		[[nodiscard]] std::uint16_t GetNode() const;
+
+	   private:
+		std::uint16_t node_;
+
+		/**
+		 * (milliseconds since Epoch << SequenceBits) | sequence, of the last ID made.
+		 */
+		std::atomic<std::uint64_t> last_ {};
+	};
+
+} // namespace narwhal
+
+#endif //NARWHAL_SNOWFLAKE_H
@@ -0,0 +1,181 @@
+#ifndef NARWHAL_TIMERWHEEL_H
+#define NARWHAL_TIMERWHEEL_H
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+
+namespace narwhal {
+
+	struct TimerWheel;
+
+	/**
+	 * An intrusive timer.
+	 *
+	 * Embed this in whatever object owns the timeout (a connection, a turn queue...).
+	 * The wheel only links timers together, so scheduling or cancelling one never allocates.
+	 *
+	 * A timer cancels itself when destroyed, and can't be copied or moved
+	 * while it's linked into a wheel.
+	 */
+	struct Timer {
+		using Callback = std::function<void()>;
+
+		Timer() = default;
+
+		explicit Timer(Callback callback);
+
+		Timer(const Timer&) = delete;
+		Timer& operator=(const Timer&) = delete;
+
+		~Timer();
+
+		/**
+		 * Set the function called when this timer fires.
+		 */
+		void SetCallback(Callback callback);
+
+		/**
+		 * Returns true if this timer is scheduled.
+		 */
+		[[nodiscard]] bool IsPending() const;
+
+		/**
+		 * Cancel this timer, if it's scheduled.
+		 */
+		void Cancel();
+
+	   private:
+		friend struct TimerWheel;
+
+		Timer* prev {};
+		Timer* next {};
+
+		/**
+		 * The wheel this timer is linked into, or nullptr if it isn't scheduled.
+		 */
+		TimerWheel* wheel {};
+
+		/**
+		 * The tick this timer expires at.
+		 */
+		std::uint64_t expiry {};
+
+		std::uint8_t level {};
+		std::uint8_t slot {};
+
+		Callback callback;
+	};
+
+	/**
+	 * A hashed hierarchical timing wheel.
+	 *
+	 * There are Levels wheels of SlotCount slots each. Level 0 has a slot per tick,
+	 * and each level above covers SlotCount times the range of the one below it.
+	 * A timer is placed on the lowest level its expiry fits in, and is cascaded down
+	 * a level whenever the wheel reaches its slot.
+	 *
+	 * Scheduling and cancellation are O(1). Each level keeps an occupancy bitmap,
+	 * so finding the next tick with work to do (for an event loop's wait timeout)
+	 * doesn't need to walk empty slots.
+	 *
+	 * This is not thread-safe; each thread should have its own wheel.
+	 */
+	struct TimerWheel {
+		using Clock = std::chrono::steady_clock;
+
+		constexpr static std::uint32_t SlotBits = 6;
+		constexpr static std::uint32_t SlotCount = 1 << SlotBits;
+		constexpr static std::uint32_t Levels = 6;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] resolution The length of a tick.
+		 * \param[in] now The time the wheel starts at.
+		 */
+		explicit TimerWheel(Clock::duration resolution = std::chrono::milliseconds(1), Clock::time_point now = Clock::now());
+
+		TimerWheel(const TimerWheel&) = delete;
+		TimerWheel& operator=(const TimerWheel&) = delete;
+
+		/**
+		 * Unlinks any timers still scheduled.
+		 */
+		~TimerWheel();
+
+		/**
+		 * Schedule a timer to fire at the given time, rescheduling it if it's already pending.
+		 * Timers never fire early, but may fire up to one tick late.
+		 *
+		 * \param[in] timer The timer to schedule.
+		 * \param[in] when When the timer should fire.
+		 */
+		void Schedule(Timer& timer, Clock::time_point when);
+
+		/**
+		 * Cancel a timer. Does nothing if the timer isn't scheduled.
+		 */
+		void Cancel(Timer& timer);
+
+		/**
+		 * Advance the wheel to the given time, firing every timer that expired.
+		 *
+		 * \param[in] now The current time.
+		 * \return How many timers fired.
+		 */
+		std::size_t Advance(Clock::time_point now = Clock::now());
+
+		/**
+		 * Get how long an event loop can wait before it needs to call Advance() again,
+		 * or std::nullopt if nothing is scheduled.
+		 *
+		 * This may be shorter than the time to the next timer, if a higher level slot
+		 * needs to be cascaded first.
+		 */
+		[[nodiscard]] std::optional<Clock::duration> NextTimeout(Clock::time_point now = Clock::now()) const;
+
+		/**
+		 * Get how many timers are scheduled.
+		 */
+		[[nodiscard]] std::size_t Size() const;
+
+	   private:
+		/**
+		 * Link a timer into the slot its expiry belongs in, relative to the current tick.
+		 *
+		 * \param[in] timer The timer to link.
+		 * \param[in] min_tick The earliest tick the timer may be placed at.
+		 */
+		void Link(Timer& timer, std::uint64_t min_tick);
+
+		void Unlink(Timer& timer);
+
+		/**
+		 * Get the next tick the wheel has to stop at, if any.
+		 */
+		[[nodiscard]] std::optional<std::uint64_t> NextTick() const;
+
+		Clock::duration resolution_;
+		Clock::time_point origin_;
+
+		/**
+		 * The last tick which has been processed.
+		 */
+		std::uint64_t current_ {};
+
+		std::size_t size_ {};
+
+		std::array<std::array<Timer*, SlotCount>, Levels> slots_ {};
+
+		/**
+		 * Bit N is set if slot N of that level has timers in it.
+		 */
+		std::array<std::uint64_t, Levels> occupied_ {};
+	};
+
+} // namespace narwhal
+
+#endif //NARWHAL_TIMERWHEEL_H
@@ -0,0 +1,108 @@
+#include <narwhal/Hash.h>
+
+#include <cstring>
+
+#ifdef _MSC_VER
+	#include <intrin.h>
+#endif
+
+namespace narwhal {
+
+	namespace {
+		constexpr std::uint64_t Prime0 = 0xa0761d6478bd642full;
+		constexpr std::uint64_t Prime1 = 0xe7037ed1a0b428dbull;
+		constexpr std::uint64_t Prime2 = 0x8ebc6af09c88c6e3ull;
+		constexpr std::uint64_t Prime3 = 0x589965cc75374cc3ull;
+
+		/**
+		 * 64x64 => 128 bit multiply, folded back down to 64 bits.
+		 */
+		inline std::uint64_t Mix(std::uint64_t a, std::uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+			auto product = static_cast<unsigned __int128>(a) * b;
+			return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+			std::uint64_t high;
+			auto low = _umul128(a, b, &high);
+			return low ^ high;
+#else
+			const std::uint64_t a_lo = a & 0xffffffff, a_hi = a >> 32;
+			const std::uint64_t b_lo = b & 0xffffffff, b_hi = b >> 32;
+			const std::uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo;
+			const std::uint64_t lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+			const std::uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xffffffff) + lo_hi;
+			const std::uint64_t low = (cross << 32) | (lo_lo & 0xffffffff);
+			const std::uint64_t high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+			return low ^ high;
+#endif
+		}
+
+		// The hash is defined over little endian loads. On big endian
+		// targets this only changes the values, not the quality.
+
+		inline std::uint64_t Read64(const std::uint8_t* p) {
+			std::uint64_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		inline std::uint64_t Read32(const std::uint8_t* p) {
+			std::uint32_t value;
+			std::memcpy(&value, p, sizeof(value));
+			return value;
+		}
+
+		inline std::uint64_t Read3(const std::uint8_t* p, std::size_t size) {
+			return (static_cast<std::uint64_t>(p[0]) << 16) | (static_cast<std::uint64_t>(p[size >> 1]) << 8) | p[size - 1];
+		}
+	} // namespace
+
+	std::uint64_t Hash64(const void* data, std::size_t size, std::uint64_t seed) {
+		auto* p = static_cast<const std::uint8_t*>(data);
+		std::uint64_t a;
+		std::uint64_t b;
+
+		seed ^= Mix(seed ^ Prime0, Prime1);
+
+		if(size <= 16) {
+			if(size >= 4) {
+				const auto offset = (size >> 3) << 2;
+				a = (Read32(p) << 32) | Read32(p + offset);
+				b = (Read32(p + size - 4) << 32) | Read32(p + size - 4 - offset);
+			} else if(size > 0) {
+				a = Read3(p, size);
+				b = 0;
+			} else {
+				a = 0;
+				b = 0;
+			}
+		} else {
+			auto left = size;
+
+			if(left > 48) {
+				auto seed1 = seed;
+				auto seed2 = seed;
+				do {
+					seed = Mix(Read64(p) ^ Prime1, Read64(p + 8) ^ seed);
+					seed1 = Mix(Read64(p + 16) ^ Prime2, Read64(p + 24) ^ seed1);
+					seed2 = Mix(Read64(p + 32) ^ Prime3, Read64(p + 40) ^ seed2);
+					p += 48;
+					left -= 48;
+				} while(left > 48);
+				seed ^= seed1 ^ seed2;
+			}
+
+			while(left > 16) {
+				seed = Mix(Read64(p) ^ Prime1, Read64(p + 8) ^ seed);
+				p += 16;
+				left -= 16;
+			}
+
+			a = Read64(p + left - 16);
+			b = Read64(p + left - 8);
+		}
+
+		return Mix(Prime1 ^ size, Mix(a ^ Prime1, b ^ seed));
+	}
+
+} // namespace narwhal
@@ -0,0 +1,505 @@
+#include <narwhal/PixelKernels.h>
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define NARWHAL_PIXELKERNELS_X86
+#endif
+
+namespace narwhal {
+
+	namespace {
+		using LumaRowFunction = void (*)(const std::uint8_t* src, std::uint8_t* y, std::uint32_t width);
+		using ChromaRowFunction = void (*)(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* u, std::uint8_t* v, std::uint32_t width);
+
+		// BT.601 limited range, in 8.8 fixed point. Every kernel computes exactly these,
+		// in 32-bit integers, so they all round the same way.
+
+		inline std::uint8_t Luma(int r, int g, int b) {
+			return static_cast<std::uint8_t>(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+		}
+
+		inline std::uint8_t ChromaU(int r, int g, int b) {
+			return static_cast<std::uint8_t>(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+		}
+
+		inline std::uint8_t ChromaV(int r, int g, int b) {
+			return static_cast<std::uint8_t>(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+		}
+
+		/**
+		 * c * a / 255, rounded to nearest, without a division.
+		 */
+		inline std::uint8_t Premultiply(unsigned c, unsigned a) {
+			const auto t = c * a + 128;
+			return static_cast<std::uint8_t>((t + (t >> 8)) >> 8);
+		}
+
+		// Scalar kernels. These are the reference the vector ones must match, and
+		// also finish the rows the vector ones stop short of.
+
+		template <bool SetAlpha>
+		void SwapRedBlueScalar(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += 4, dest += 4) {
+				const auto r = src[2];
+				const auto b = src[0];
+				dest[0] = r;
+				dest[1] = src[1];
+				dest[2] = b;
+				dest[3] = SetAlpha ? 0xFF : src[3];
+			}
+		}
+
+		void Rgb565ToBgrxScalar(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += 2, dest += 4) {
+				const unsigned pixel = src[0] | (src[1] << 8);
+				const unsigned r = pixel >> 11;
+				const unsigned g = (pixel >> 5) & 0x3f;
+				const unsigned b = pixel & 0x1f;
+				dest[0] = static_cast<std::uint8_t>((b << 3) | (b >> 2));
+				dest[1] = static_cast<std::uint8_t>((g << 2) | (g >> 4));
+				dest[2] = static_cast<std::uint8_t>((r << 3) | (r >> 2));
+				dest[3] = 0xFF;
+			}
+		}
+
+		void PremultiplyAlphaScalar(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			for(std::size_t i = 0; i < pixels; ++i, src += 4, dest += 4) {
+				const auto a = src[3];
+				dest[0] = Premultiply(src[0], a);
+				dest[1] = Premultiply(src[1], a);
+				dest[2] = Premultiply(src[2], a);
+				dest[3] = a;
+			}
+		}
+
+		/**
+		 * R and B are the byte offsets of red and blue in a pixel; green is always 1.
+		 */
+		template <std::size_t R, std::size_t B>
+		void LumaRowScalar(const std::uint8_t* src, std::uint8_t* y, std::uint32_t width) {
+			for(std::uint32_t x = 0; x < width; ++x, src += 4)
+				y[x] = Luma(src[R], src[1], src[B]);
+		}
+
+		/**
+		 * Chroma of one row pair. A missing right column is replicated, which averages out to just the left one.
+		 */
+		template <std::size_t R, std::size_t B>
+		void ChromaRowScalar(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* u, std::uint8_t* v, std::uint32_t width) {
+			for(std::uint32_t x = 0; x < width; x += 2) {
+				const auto right = (x + 1 < width) ? 4 : 0;
+				const auto* p0 = row0 + x * 4;
+				const auto* p1 = row1 + x * 4;
+
+				const auto average = [&](std::size_t c) {
+					return (p0[c] + p0[c + right] + p1[c] + p1[c + right] + 2) >> 2;
+				};
+
+				const auto r = average(R);
+				const auto g = average(1);
+				const auto b = average(B);
+				u[x / 2] = ChromaU(r, g, b);
+				v[x / 2] = ChromaV(r, g, b);
+			}
+		}
+
+		/**
+		 * Walks an image two rows at a time. A missing last row is replicated, like a missing column.
+		 */
+		template <LumaRowFunction LumaRow, ChromaRowFunction ChromaRow>
+		void ToI420(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const I420Planes& dest) {
+			for(std::uint32_t y = 0; y < height; y += 2) {
+				const auto* row0 = src + y * stride;
+				const auto* row1 = (y + 1 < height) ? row0 + stride : row0;
+
+				LumaRow(row0, dest.y + y * dest.y_stride, width);
+				if(row1 != row0)
+					LumaRow(row1, dest.y + (y + 1) * dest.y_stride, width);
+
+				ChromaRow(row0, row1, dest.u + (y / 2) * dest.u_stride, dest.v + (y / 2) * dest.v_stride, width);
+			}
+		}
+
+#ifdef NARWHAL_PIXELKERNELS_X86
+		/**
+		 * Madd coefficients for one of the formulas above, laid out like a pixel with 16-bit channels.
+		 */
+		template <std::size_t R, std::size_t B>
+		constexpr std::int16_t Coefficient(std::size_t channel, std::int16_t r, std::int16_t g, std::int16_t b) {
+			return channel == R ? r : channel == B ? b : channel == 1 ? g : 0;
+		}
+
+	#define NARWHAL_COEFFICIENTS(r, g, b)                                                                          \
+		Coefficient<R, B>(0, r, g, b), Coefficient<R, B>(1, r, g, b), Coefficient<R, B>(2, r, g, b), Coefficient<R, B>(3, r, g, b), \
+			Coefficient<R, B>(0, r, g, b), Coefficient<R, B>(1, r, g, b), Coefficient<R, B>(2, r, g, b), Coefficient<R, B>(3, r, g, b)
+
+		// SSE4.1 (which includes the SSSE3 byte shuffle).
+
+		__attribute__((target("sse4.1"))) inline __m128i SwapRedBlueMask() {
+			return _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+		}
+
+		template <bool SetAlpha>
+		__attribute__((target("sse4.1"))) void SwapRedBlueSse41(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto mask = SwapRedBlueMask();
+			const auto alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+			std::size_t i = 0;
+
+			for(; i + 4 <= pixels; i += 4) {
+				auto data = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4)), mask);
+				if constexpr(SetAlpha)
+					data = _mm_or_si128(data, alpha);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4), data);
+			}
+
+			SwapRedBlueScalar<SetAlpha>(src + i * 4, dest + i * 4, pixels - i);
+		}
+
+		__attribute__((target("sse4.1"))) void Rgb565ToBgrxSse41(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto mask5 = _mm_set1_epi16(0x1f);
+			const auto mask6 = _mm_set1_epi16(0x3f);
+			const auto alpha = _mm_set1_epi16(static_cast<short>(0xFF00));
+			std::size_t i = 0;
+
+			for(; i + 8 <= pixels; i += 8) {
+				const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 2));
+				const auto r = _mm_srli_epi16(data, 11);
+				const auto g = _mm_and_si128(_mm_srli_epi16(data, 5), mask6);
+				const auto b = _mm_and_si128(data, mask5);
+
+				const auto r8 = _mm_or_si128(_mm_slli_epi16(r, 3), _mm_srli_epi16(r, 2));
+				const auto g8 = _mm_or_si128(_mm_slli_epi16(g, 2), _mm_srli_epi16(g, 4));
+				const auto b8 = _mm_or_si128(_mm_slli_epi16(b, 3), _mm_srli_epi16(b, 2));
+
+				const auto bg = _mm_or_si128(b8, _mm_slli_epi16(g8, 8));
+				const auto ra = _mm_or_si128(r8, alpha);
+
+				auto* out = reinterpret_cast<__m128i*>(dest + i * 4);
+				_mm_storeu_si128(out, _mm_unpacklo_epi16(bg, ra));
+				_mm_storeu_si128(out + 1, _mm_unpackhi_epi16(bg, ra));
+			}
+
+			Rgb565ToBgrxScalar(src + i * 2, dest + i * 4, pixels - i);
+		}
+
+		/**
+		 * Premultiply two pixels with 16-bit channels. Their alpha comes out wrong, and is put back by the caller.
+		 */
+		__attribute__((target("sse4.1"))) inline __m128i Premultiply2(__m128i pixels) {
+			const auto alpha = _mm_shuffle_epi8(pixels, _mm_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+			const auto t = _mm_add_epi16(_mm_mullo_epi16(pixels, alpha), _mm_set1_epi16(128));
+			return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+		}
+
+		__attribute__((target("sse4.1"))) void PremultiplyAlphaSse41(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto zero = _mm_setzero_si128();
+			const auto alpha = _mm_set1_epi32(static_cast<int>(0xFF000000));
+			std::size_t i = 0;
+
+			for(; i + 4 <= pixels; i += 4) {
+				const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i * 4));
+				const auto lo = Premultiply2(_mm_unpacklo_epi8(data, zero));
+				const auto hi = Premultiply2(_mm_unpackhi_epi8(data, zero));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dest + i * 4), _mm_blendv_epi8(_mm_packus_epi16(lo, hi), data, alpha));
+			}
+
+			PremultiplyAlphaScalar(src + i * 4, dest + i * 4, pixels - i);
+		}
+
+		/**
+		 * Apply a madd coefficient set to 4 pixels, giving 4 32-bit sums.
+		 */
+		__attribute__((target("sse4.1"))) inline __m128i Dot4(__m128i pixels, __m128i coefficients) {
+			const auto zero = _mm_setzero_si128();
+			const auto lo = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coefficients);
+			const auto hi = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coefficients);
+			return _mm_hadd_epi32(lo, hi);
+		}
+
+		template <std::size_t R, std::size_t B>
+		__attribute__((target("sse4.1"))) void LumaRowSse41(const std::uint8_t* src, std::uint8_t* y, std::uint32_t width) {
+			const auto coefficients = _mm_setr_epi16(NARWHAL_COEFFICIENTS(66, 129, 25));
+			const auto round = _mm_set1_epi32(128);
+			const auto offset = _mm_set1_epi32(16);
+			std::uint32_t x = 0;
+
+			for(; x + 8 <= width; x += 8) {
+				const auto* p = reinterpret_cast<const __m128i*>(src + x * 4);
+				auto s0 = Dot4(_mm_loadu_si128(p), coefficients);
+				auto s1 = Dot4(_mm_loadu_si128(p + 1), coefficients);
+				s0 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(s0, round), 8), offset);
+				s1 = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(s1, round), 8), offset);
+
+				const auto words = _mm_packs_epi32(s0, s1);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(y + x), _mm_packus_epi16(words, words));
+			}
+
+			LumaRowScalar<R, B>(src + x * 4, y + x, width - x);
+		}
+
+		/**
+		 * Rounded averages of the two 2x2 blocks in 4 pixels of two rows, with 16-bit channels.
+		 */
+		__attribute__((target("sse4.1"))) inline __m128i Average2x2(__m128i row0, __m128i row1) {
+			const auto zero = _mm_setzero_si128();
+			const auto lo = _mm_add_epi16(_mm_unpacklo_epi8(row0, zero), _mm_unpacklo_epi8(row1, zero));
+			const auto hi = _mm_add_epi16(_mm_unpackhi_epi8(row0, zero), _mm_unpackhi_epi8(row1, zero));
+			const auto sum = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+			return _mm_srli_epi16(_mm_add_epi16(sum, _mm_set1_epi16(2)), 2);
+		}
+
+		template <std::size_t R, std::size_t B>
+		__attribute__((target("sse4.1"))) void ChromaRowSse41(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* u, std::uint8_t* v, std::uint32_t width) {
+			const auto u_coefficients = _mm_setr_epi16(NARWHAL_COEFFICIENTS(-38, -74, 112));
+			const auto v_coefficients = _mm_setr_epi16(NARWHAL_COEFFICIENTS(112, -94, -18));
+			const auto round = _mm_set1_epi32(128);
+			const auto offset = _mm_set1_epi32(128);
+			std::uint32_t x = 0;
+
+			for(; x + 8 <= width; x += 8) {
+				const auto* p0 = reinterpret_cast<const __m128i*>(row0 + x * 4);
+				const auto* p1 = reinterpret_cast<const __m128i*>(row1 + x * 4);
+				const auto a = Average2x2(_mm_loadu_si128(p0), _mm_loadu_si128(p1));
+				const auto b = Average2x2(_mm_loadu_si128(p0 + 1), _mm_loadu_si128(p1 + 1));
+
+				auto us = _mm_hadd_epi32(_mm_madd_epi16(a, u_coefficients), _mm_madd_epi16(b, u_coefficients));
+				auto vs = _mm_hadd_epi32(_mm_madd_epi16(a, v_coefficients), _mm_madd_epi16(b, v_coefficients));
+				us = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(us, round), 8), offset);
+				vs = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(vs, round), 8), offset);
+
+				const auto words = _mm_packs_epi32(us, vs);
+				const auto bytes = _mm_packus_epi16(words, words);
+				const auto u4 = _mm_cvtsi128_si32(bytes);
+				const auto v4 = _mm_extract_epi32(bytes, 1);
+				std::memcpy(u + x / 2, &u4, 4);
+				std::memcpy(v + x / 2, &v4, 4);
+			}
+
+			ChromaRowScalar<R, B>(row0 + x * 4, row1 + x * 4, u + x / 2, v + x / 2, width - x);
+		}
+
+		// AVX2. Most instructions work within each 128-bit half, so results that
+		// come out interleaved by half are put back in order with a permute.
+
+		template <bool SetAlpha>
+		__attribute__((target("avx2"))) void SwapRedBlueAvx2(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto mask = _mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15,
+											   2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+			const auto alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+			std::size_t i = 0;
+
+			for(; i + 8 <= pixels; i += 8) {
+				auto data = _mm256_shuffle_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4)), mask);
+				if constexpr(SetAlpha)
+					data = _mm256_or_si256(data, alpha);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4), data);
+			}
+
+			SwapRedBlueScalar<SetAlpha>(src + i * 4, dest + i * 4, pixels - i);
+		}
+
+		__attribute__((target("avx2"))) void Rgb565ToBgrxAvx2(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto mask5 = _mm256_set1_epi16(0x1f);
+			const auto mask6 = _mm256_set1_epi16(0x3f);
+			const auto alpha = _mm256_set1_epi16(static_cast<short>(0xFF00));
+			std::size_t i = 0;
+
+			for(; i + 16 <= pixels; i += 16) {
+				const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
+				const auto r = _mm256_srli_epi16(data, 11);
+				const auto g = _mm256_and_si256(_mm256_srli_epi16(data, 5), mask6);
+				const auto b = _mm256_and_si256(data, mask5);
+
+				const auto r8 = _mm256_or_si256(_mm256_slli_epi16(r, 3), _mm256_srli_epi16(r, 2));
+				const auto g8 = _mm256_or_si256(_mm256_slli_epi16(g, 2), _mm256_srli_epi16(g, 4));
+				const auto b8 = _mm256_or_si256(_mm256_slli_epi16(b, 3), _mm256_srli_epi16(b, 2));
+
+				const auto bg = _mm256_or_si256(b8, _mm256_slli_epi16(g8, 8));
+				const auto ra = _mm256_or_si256(r8, alpha);
+
+				// Pixels 0-3 and 8-11, then 4-7 and 12-15.
+				const auto lo = _mm256_unpacklo_epi16(bg, ra);
+				const auto hi = _mm256_unpackhi_epi16(bg, ra);
+
+				auto* out = reinterpret_cast<__m256i*>(dest + i * 4);
+				_mm256_storeu_si256(out, _mm256_permute2x128_si256(lo, hi, 0x20));
+				_mm256_storeu_si256(out + 1, _mm256_permute2x128_si256(lo, hi, 0x31));
+			}
+
+			Rgb565ToBgrxScalar(src + i * 2, dest + i * 4, pixels - i);
+		}
+
+		__attribute__((target("avx2"))) inline __m256i Premultiply4(__m256i pixels) {
+			const auto alpha = _mm256_shuffle_epi8(pixels, _mm256_setr_epi8(6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15,
+																			 6, 7, 6, 7, 6, 7, 6, 7, 14, 15, 14, 15, 14, 15, 14, 15));
+			const auto t = _mm256_add_epi16(_mm256_mullo_epi16(pixels, alpha), _mm256_set1_epi16(128));
+			return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+		}
+
+		__attribute__((target("avx2"))) void PremultiplyAlphaAvx2(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels) {
+			const auto zero = _mm256_setzero_si256();
+			const auto alpha = _mm256_set1_epi32(static_cast<int>(0xFF000000));
+			std::size_t i = 0;
+
+			for(; i + 8 <= pixels; i += 8) {
+				const auto data = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 4));
+				const auto lo = Premultiply4(_mm256_unpacklo_epi8(data, zero));
+				const auto hi = Premultiply4(_mm256_unpackhi_epi8(data, zero));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + i * 4), _mm256_blendv_epi8(_mm256_packus_epi16(lo, hi), data, alpha));
+			}
+
+			PremultiplyAlphaScalar(src + i * 4, dest + i * 4, pixels - i);
+		}
+
+		/**
+		 * Apply a madd coefficient set to 8 pixels, giving 8 32-bit sums in order.
+		 */
+		__attribute__((target("avx2"))) inline __m256i Dot8(__m256i pixels, __m256i coefficients) {
+			const auto zero = _mm256_setzero_si256();
+			const auto lo = _mm256_madd_epi16(_mm256_unpacklo_epi8(pixels, zero), coefficients);
+			const auto hi = _mm256_madd_epi16(_mm256_unpackhi_epi8(pixels, zero), coefficients);
+			return _mm256_hadd_epi32(lo, hi);
+		}
+
+		template <std::size_t R, std::size_t B>
+		__attribute__((target("avx2"))) void LumaRowAvx2(const std::uint8_t* src, std::uint8_t* y, std::uint32_t width) {
+			const auto coefficients = _mm256_setr_epi16(NARWHAL_COEFFICIENTS(66, 129, 25), NARWHAL_COEFFICIENTS(66, 129, 25));
+			const auto round = _mm256_set1_epi32(128);
+			const auto offset = _mm256_set1_epi32(16);
+			std::uint32_t x = 0;
+
+			for(; x + 16 <= width; x += 16) {
+				const auto* p = reinterpret_cast<const __m256i*>(src + x * 4);
+				auto s0 = Dot8(_mm256_loadu_si256(p), coefficients);
+				auto s1 = Dot8(_mm256_loadu_si256(p + 1), coefficients);
+				s0 = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(s0, round), 8), offset);
+				s1 = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(s1, round), 8), offset);
+
+				// 0-3 8-11 | 4-7 12-15 => 0-7 | 8-15
+				const auto words = _mm256_permute4x64_epi64(_mm256_packs_epi32(s0, s1), 0xd8);
+				const auto bytes = _mm256_permute4x64_epi64(_mm256_packus_epi16(words, words), 0xd8);
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(y + x), _mm256_castsi256_si128(bytes));
+			}
+
+			LumaRowSse41<R, B>(src + x * 4, y + x, width - x);
+		}
+
+		/**
+		 * Rounded averages of the four 2x2 blocks in 8 pixels of two rows, in order, with 16-bit channels.
+		 */
+		__attribute__((target("avx2"))) inline __m256i Average2x2(__m256i row0, __m256i row1) {
+			const auto zero = _mm256_setzero_si256();
+			const auto lo = _mm256_add_epi16(_mm256_unpacklo_epi8(row0, zero), _mm256_unpacklo_epi8(row1, zero));
+			const auto hi = _mm256_add_epi16(_mm256_unpackhi_epi8(row0, zero), _mm256_unpackhi_epi8(row1, zero));
+			const auto sum = _mm256_add_epi16(_mm256_unpacklo_epi64(lo, hi), _mm256_unpackhi_epi64(lo, hi));
+			return _mm256_srli_epi16(_mm256_add_epi16(sum, _mm256_set1_epi16(2)), 2);
+		}
+
+		template <std::size_t R, std::size_t B>
+		__attribute__((target("avx2"))) void ChromaRowAvx2(const std::uint8_t* row0, const std::uint8_t* row1, std::uint8_t* u, std::uint8_t* v, std::uint32_t width) {
+			const auto u_coefficients = _mm256_setr_epi16(NARWHAL_COEFFICIENTS(-38, -74, 112), NARWHAL_COEFFICIENTS(-38, -74, 112));
+			const auto v_coefficients = _mm256_setr_epi16(NARWHAL_COEFFICIENTS(112, -94, -18), NARWHAL_COEFFICIENTS(112, -94, -18));
+			const auto round = _mm256_set1_epi32(128);
+			const auto offset = _mm256_set1_epi32(128);
+			const auto order = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+			const auto split = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+			std::uint32_t x = 0;
+
+			for(; x + 16 <= width; x += 16) {
+				const auto* p0 = reinterpret_cast<const __m256i*>(row0 + x * 4);
+				const auto* p1 = reinterpret_cast<const __m256i*>(row1 + x * 4);
+				const auto a = Average2x2(_mm256_loadu_si256(p0), _mm256_loadu_si256(p1));
+				const auto b = Average2x2(_mm256_loadu_si256(p0 + 1), _mm256_loadu_si256(p1 + 1));
+
+				// Blocks 0 1 4 5 | 2 3 6 7 => 0-7
+				auto us = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(a, u_coefficients), _mm256_madd_epi16(b, u_coefficients)), order);
+				auto vs = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(_mm256_madd_epi16(a, v_coefficients), _mm256_madd_epi16(b, v_coefficients)), order);
+				us = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(us, round), 8), offset);
+				vs = _mm256_add_epi32(_mm256_srai_epi32(_mm256_add_epi32(vs, round), 8), offset);
+
+				// u0-3 v0-3 | u4-7 v4-7 => u0-7 v0-7
+				const auto words = _mm256_packs_epi32(us, vs);
+				const auto bytes = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(_mm256_packus_epi16(words, words), split));
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(u + x / 2), bytes);
+				_mm_storel_epi64(reinterpret_cast<__m128i*>(v + x / 2), _mm_unpackhi_epi64(bytes, bytes));
+			}
+
+			ChromaRowSse41<R, B>(row0 + x * 4, row1 + x * 4, u + x / 2, v + x / 2, width - x);
+		}
+
+	#undef NARWHAL_COEFFICIENTS
+#endif
+
+		constexpr PixelKernels ScalarKernels {
+			"scalar",
+			SimdLevel::Scalar,
+			&SwapRedBlueScalar<true>,
+			&SwapRedBlueScalar<false>,
+			&Rgb565ToBgrxScalar,
+			&PremultiplyAlphaScalar,
+			&ToI420<&LumaRowScalar<0, 2>, &ChromaRowScalar<0, 2>>,
+			&ToI420<&LumaRowScalar<2, 0>, &ChromaRowScalar<2, 0>>
+		};
+
+#ifdef NARWHAL_PIXELKERNELS_X86
+		constexpr PixelKernels Sse41Kernels {
+			"sse4.1",
+			SimdLevel::Sse41,
+			&SwapRedBlueSse41<true>,
+			&SwapRedBlueSse41<false>,
+			&Rgb565ToBgrxSse41,
+			&PremultiplyAlphaSse41,
+			&ToI420<&LumaRowSse41<0, 2>, &ChromaRowSse41<0, 2>>,
+			&ToI420<&LumaRowSse41<2, 0>, &ChromaRowSse41<2, 0>>
+		};
+
+		constexpr PixelKernels Avx2Kernels {
+			"avx2",
+			SimdLevel::Avx2,
+			&SwapRedBlueAvx2<true>,
+			&SwapRedBlueAvx2<false>,
+			&Rgb565ToBgrxAvx2,
+			&PremultiplyAlphaAvx2,
+			&ToI420<&LumaRowAvx2<0, 2>, &ChromaRowAvx2<0, 2>>,
+			&ToI420<&LumaRowAvx2<2, 0>, &ChromaRowAvx2<2, 0>>
+		};
+#endif
+
+		SimdLevel DetectLevel() {
+#ifdef NARWHAL_PIXELKERNELS_X86
+			__builtin_cpu_init();
+			if(__builtin_cpu_supports("avx2"))
+				return SimdLevel::Avx2;
+			if(__builtin_cpu_supports("sse4.1"))
+				return SimdLevel::Sse41;
+#endif
+			return SimdLevel::Scalar;
+		}
+
+	} // namespace
+
+	const PixelKernels& GetPixelKernels() {
+		static const auto& kernels = GetPixelKernels(SimdLevel::Avx2);
+		return kernels;
+	}
+
+	const PixelKernels& GetPixelKernels(SimdLevel level) {
+		static const auto supported = DetectLevel();
+		if(level > supported)
+			level = supported;
+
+		switch(level) {
+#ifdef NARWHAL_PIXELKERNELS_X86
+			case SimdLevel::Avx2:
+				return Avx2Kernels;
+			case SimdLevel::Sse41:
+				return Sse41Kernels;
+#endif
+			default:
+				return ScalarKernels;
+		}
+	}
+
+} // namespace narwhal
@@ -0,0 +1,55 @@
+#include <narwhal/Snowflake.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace narwhal {
+
+	namespace {
+		constexpr std::uint64_t TimestampMask = (std::uint64_t { 1 } << Snowflake::TimestampBits) - 1;
+	} // namespace
+
+	Snowflake Snowflake::Split(std::uint64_t id) {
+		Snowflake snowflake;
+		snowflake.sequence = static_cast<std::uint16_t>(id & MaxSequence);
+		snowflake.node = static_cast<std::uint16_t>((id >> SequenceBits) & MaxNode);
+		snowflake.timestamp = ((id >> (SequenceBits + NodeBits)) & TimestampMask) + Epoch;
+		return snowflake;
+	}
+
+	std::uint64_t Snowflake::Join() const {
+		const auto since_epoch = timestamp > Epoch ? timestamp - Epoch : 0;
+		return ((since_epoch & TimestampMask) << (SequenceBits + NodeBits))
+			   | (static_cast<std::uint64_t>(node & MaxNode) << SequenceBits)
+			   | (sequence & MaxSequence);
+	}
+
+	SnowflakeGenerator::SnowflakeGenerator(std::uint16_t node)
+		: node_(node) {
+		if(node > Snowflake::MaxNode)
+			throw std::invalid_argument("Snowflake node ID out of range");
+	}
+
+	std::uint64_t SnowflakeGenerator::Next(Clock::time_point now) {
+		const auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count();
+		const auto since_epoch = millis > static_cast<std::int64_t>(Snowflake::Epoch) ? static_cast<std::uint64_t>(millis) - Snowflake::Epoch : 0;
+		const auto floor = since_epoch << Snowflake::SequenceBits;
+
+		// The next sequence number after the last ID, carrying into the timestamp once
+		// the sequence runs out; or the start of the current millisecond, if that's later.
+		auto last = last_.load(std::memory_order_relaxed);
+		std::uint64_t next;
+		do {
+			next = std::max(last + 1, floor);
+		} while(!last_.compare_exchange_weak(last, next, std::memory_order_relaxed));
+
+		return ((next >> Snowflake::SequenceBits) << (Snowflake::SequenceBits + Snowflake::NodeBits))
+			   | (static_cast<std::uint64_t>(node_) << Snowflake::SequenceBits)
+			   | (next & Snowflake::MaxSequence);
+	}
+
+	std::uint16_t SnowflakeGenerator::GetNode() const {
+		return node_;
+	}
+
+} // namespace narwhal
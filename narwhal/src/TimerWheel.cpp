@@ -0,0 +1,211 @@
+#include <narwhal/TimerWheel.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace narwhal {
+
+	Timer::Timer(Callback callback)
+		: callback(std::move(callback)) {
+	}
+
+	Timer::~Timer() {
+		Cancel();
+	}
+
+	void Timer::SetCallback(Callback callback) {
+		this->callback = std::move(callback);
+	}
+
+	bool Timer::IsPending() const {
+		return wheel != nullptr;
+	}
+
+	void Timer::Cancel() {
+		if(wheel)
+			wheel->Cancel(*this);
+	}
+
+	TimerWheel::TimerWheel(Clock::duration resolution, Clock::time_point now)
+		: resolution_(resolution),
+		  origin_(now) {
+	}
+
+	TimerWheel::~TimerWheel() {
+		for(auto& level : slots_) {
+			for(auto& head : level) {
+				while(head) {
+					auto* timer = head;
+					head = timer->next;
+
+					timer->prev = nullptr;
+					timer->next = nullptr;
+					timer->wheel = nullptr;
+				}
+			}
+		}
+	}
+
+	void TimerWheel::Schedule(Timer& timer, Clock::time_point when) {
+		timer.Cancel();
+
+		// Round up, so that timers never fire early.
+		auto offset = when - origin_;
+		if(offset <= Clock::duration::zero())
+			timer.expiry = 0;
+		else
+			timer.expiry = static_cast<std::uint64_t>((offset + resolution_ - Clock::duration(1)) / resolution_);
+
+		Link(timer, current_ + 1);
+	}
+
+	void TimerWheel::Cancel(Timer& timer) {
+		if(timer.wheel != this)
+			return;
+		Unlink(timer);
+	}
+
+	std::size_t TimerWheel::Advance(Clock::time_point now) {
+		auto offset = now - origin_;
+		if(offset < Clock::duration::zero())
+			return 0;
+
+		const auto target = static_cast<std::uint64_t>(offset / resolution_);
+		std::size_t fired = 0;
+
+		while(true) {
+			auto next = NextTick();
+			if(!next.has_value() || *next > target)
+				break;
+
+			current_ = *next;
+
+			// Cascade any higher level slots which start at this tick, from the top down,
+			// since a timer cascaded from one level may land in a slot of the level below
+			// which also starts now.
+			for(auto level = Levels - 1; level > 0; --level) {
+				const auto shift = SlotBits * level;
+				if(current_ & ((std::uint64_t { 1 } << shift) - 1))
+					continue;
+
+				auto& head = slots_[level][(current_ >> shift) & (SlotCount - 1)];
+				while(head) {
+					auto* timer = head;
+					Unlink(*timer);
+					Link(*timer, current_);
+				}
+			}
+
+			auto& head = slots_[0][current_ & (SlotCount - 1)];
+			while(head) {
+				auto* timer = head;
+				Unlink(*timer);
+
+				// This can happen for timers further out than the wheel can represent;
+				// they just go around again.
+				if(timer->expiry > current_) {
+					Link(*timer, current_ + 1);
+					continue;
+				}
+
+				++fired;
+				if(timer->callback)
+					timer->callback();
+			}
+		}
+
+		current_ = std::max(current_, target);
+		return fired;
+	}
+
+	std::optional<TimerWheel::Clock::duration> TimerWheel::NextTimeout(Clock::time_point now) const {
+		auto next = NextTick();
+		if(!next.has_value())
+			return std::nullopt;
+
+		auto when = origin_ + resolution_ * static_cast<std::int64_t>(*next);
+		return std::max(when - now, Clock::duration::zero());
+	}
+
+	std::size_t TimerWheel::Size() const {
+		return size_;
+	}
+
+	void TimerWheel::Link(Timer& timer, std::uint64_t min_tick) {
+		const auto when = std::max(timer.expiry, min_tick);
+
+		// The level is picked by the highest bit group in which the expiry and the
+		// current tick differ, so a timer's slot is always ahead of the current slot on its level.
+		const auto diff = when ^ current_;
+		std::uint32_t level = diff ? (std::bit_width(diff) - 1) / SlotBits : 0;
+		std::uint32_t slot;
+
+		if(level >= Levels) {
+			// Too far out; park it in the top level slot furthest from now.
+			// It gets cascaded (and relinked) well before it expires.
+			level = Levels - 1;
+			slot = ((current_ >> (SlotBits * level)) + SlotCount - 1) & (SlotCount - 1);
+		} else {
+			slot = (when >> (SlotBits * level)) & (SlotCount - 1);
+		}
+
+		auto& head = slots_[level][slot];
+
+		timer.wheel = this;
+		timer.level = static_cast<std::uint8_t>(level);
+		timer.slot = static_cast<std::uint8_t>(slot);
+		timer.prev = nullptr;
+		timer.next = head;
+
+		if(head)
+			head->prev = &timer;
+		head = &timer;
+
+		occupied_[level] |= std::uint64_t { 1 } << slot;
+		++size_;
+	}
+
+	void TimerWheel::Unlink(Timer& timer) {
+		auto& head = slots_[timer.level][timer.slot];
+
+		if(timer.prev)
+			timer.prev->next = timer.next;
+		else
+			head = timer.next;
+
+		if(timer.next)
+			timer.next->prev = timer.prev;
+
+		if(!head)
+			occupied_[timer.level] &= ~(std::uint64_t { 1 } << timer.slot);
+
+		timer.prev = nullptr;
+		timer.next = nullptr;
+		timer.wheel = nullptr;
+		--size_;
+	}
+
+	std::optional<std::uint64_t> TimerWheel::NextTick() const {
+		std::optional<std::uint64_t> next;
+
+		for(std::uint32_t level = 0; level < Levels; ++level) {
+			if(!occupied_[level])
+				continue;
+
+			// Search the occupancy bitmap starting from the slot after the current one.
+			// Slot N on a level is always reached at the start of its range, so that is
+			// when it either fires (level 0) or has to be cascaded.
+			const auto shift = SlotBits * level;
+			const auto index = (current_ >> shift) & (SlotCount - 1);
+			const auto rotated = std::rotr(occupied_[level], static_cast<int>((index + 1) & (SlotCount - 1)));
+			const auto distance = static_cast<std::uint64_t>(std::countr_zero(rotated)) + 1;
+
+			const auto tick = ((current_ >> shift) + distance) << shift;
+			if(!next.has_value() || tick < *next)
+				next = tick;
+		}
+
+		return next;
+	}
+
+} // namespace narwhal
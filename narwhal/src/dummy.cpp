@@ -1,2 +0,0 @@
-// dummy tu for narwhal
-// TODO Put code in here please
\ No newline at end of file
@@ -0,0 +1,169 @@
+// Checks every level of PixelKernels against the scalar reference, byte for byte,
+// over random lengths, unaligned buffers and odd I420 sizes. Levels this CPU can't
+// run are skipped.
+
+#include <narwhal/PixelKernels.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace {
+	using narwhal::PixelKernels;
+	using narwhal::SimdLevel;
+
+	constexpr int Rounds = 2000;
+	constexpr int I420Rounds = 500;
+
+	/**
+	 * Largest misalignment tried, in bytes.
+	 */
+	constexpr std::size_t MaxOffset = 31;
+
+	std::mt19937 random(1234);
+	int failures = 0;
+
+	void Fail(const PixelKernels& kernels, const char* conversion, const char* format, std::size_t a, std::size_t b) {
+		if(failures++ < 20) {
+			std::printf("FAIL %s %s: ", kernels.name, conversion);
+			std::printf(format, a, b);
+			std::printf("\n");
+		}
+	}
+
+	std::vector<std::uint8_t> RandomBytes(std::size_t size) {
+		std::vector<std::uint8_t> bytes(size);
+		for(auto& byte : bytes)
+			byte = static_cast<std::uint8_t>(random());
+		return bytes;
+	}
+
+	std::size_t RandomBelow(std::size_t n) {
+		return std::uniform_int_distribution<std::size_t>(0, n - 1)(random);
+	}
+
+	using PixelFunction = void (*)(const std::uint8_t* src, std::uint8_t* dest, std::size_t pixels);
+
+	void CheckPixels(const PixelKernels& kernels, const char* name, PixelFunction PixelKernels::*function, std::size_t src_bpp, std::size_t dest_bpp) {
+		const auto& scalar = narwhal::GetPixelKernels(SimdLevel::Scalar);
+
+		for(int round = 0; round < Rounds; ++round) {
+			const auto pixels = RandomBelow(1000);
+			const auto src_offset = RandomBelow(MaxOffset + 1);
+			const auto dest_offset = RandomBelow(MaxOffset + 1);
+
+			const auto src = RandomBytes(src_offset + pixels * src_bpp);
+
+			// Fill both destinations the same, so bytes written past the end show up too.
+			const auto fill = RandomBytes(dest_offset + pixels * dest_bpp + 64);
+			auto expected = fill;
+			auto actual = fill;
+
+			(scalar.*function)(src.data() + src_offset, expected.data() + dest_offset, pixels);
+			(kernels.*function)(src.data() + src_offset, actual.data() + dest_offset, pixels);
+
+			if(expected != actual)
+				Fail(kernels, name, "%zu pixels at offset %zu", pixels, dest_offset);
+
+			// In place, where that's allowed.
+			if(src_bpp == dest_bpp && function == &PixelKernels::premultiply_alpha) {
+				auto in_place = src;
+				(kernels.*function)(in_place.data() + src_offset, in_place.data() + src_offset, pixels);
+				if(!std::equal(in_place.begin() + src_offset, in_place.end(), expected.begin() + dest_offset))
+					Fail(kernels, name, "%zu pixels in place at offset %zu", pixels, src_offset);
+			}
+		}
+	}
+
+	using I420Function = void (*)(const std::uint8_t* src, std::size_t stride, std::uint32_t width, std::uint32_t height, const narwhal::I420Planes& dest);
+
+	struct I420Image {
+		std::vector<std::uint8_t> y, u, v;
+		narwhal::I420Planes planes {};
+
+		I420Image(std::uint32_t width, std::uint32_t height, std::size_t padding, const std::vector<std::uint8_t>& fill) {
+			const std::size_t chroma_width = (width + 1) / 2;
+			const std::size_t chroma_height = (height + 1) / 2;
+
+			y.assign(fill.begin(), fill.begin() + (width + padding) * height);
+			u.assign(fill.begin(), fill.begin() + (chroma_width + padding) * chroma_height);
+			v.assign(fill.begin(), fill.begin() + (chroma_width + padding) * chroma_height);
+			planes = { y.data(), width + padding, u.data(), chroma_width + padding, v.data(), chroma_width + padding };
+		}
+
+		bool operator==(const I420Image& other) const {
+			return y == other.y && u == other.u && v == other.v;
+		}
+	};
+
+	void CheckI420(const PixelKernels& kernels, const char* name, I420Function PixelKernels::*function) {
+		const auto& scalar = narwhal::GetPixelKernels(SimdLevel::Scalar);
+
+		for(int round = 0; round < I420Rounds; ++round) {
+			const auto width = static_cast<std::uint32_t>(1 + RandomBelow(200));
+			const auto height = static_cast<std::uint32_t>(1 + RandomBelow(64));
+			const auto offset = RandomBelow(MaxOffset + 1);
+			const auto stride = width * 4 + RandomBelow(MaxOffset + 1);
+			const auto padding = RandomBelow(16);
+
+			const auto src = RandomBytes(offset + stride * height);
+			const auto fill = RandomBytes((width + padding) * height);
+
+			I420Image expected(width, height, padding, fill);
+			I420Image actual(width, height, padding, fill);
+
+			(scalar.*function)(src.data() + offset, stride, width, height, expected.planes);
+			(kernels.*function)(src.data() + offset, stride, width, height, actual.planes);
+
+			if(!(expected == actual))
+				Fail(kernels, name, "%zux%zu", width, height);
+		}
+	}
+
+	/**
+	 * The scalar premultiply must round to nearest, for every colour and alpha.
+	 */
+	void CheckPremultiplyReference() {
+		const auto& scalar = narwhal::GetPixelKernels(SimdLevel::Scalar);
+
+		for(unsigned a = 0; a < 256; ++a) {
+			for(unsigned c = 0; c < 256; ++c) {
+				const std::uint8_t src[4] = { static_cast<std::uint8_t>(c), 0, 0, static_cast<std::uint8_t>(a) };
+				std::uint8_t dest[4];
+				scalar.premultiply_alpha(src, dest, 1);
+
+				const auto expected = static_cast<unsigned>(std::lround(c * a / 255.0));
+				if(dest[0] != expected)
+					Fail(scalar, "premultiply_alpha", "c=%zu a=%zu", c, a);
+			}
+		}
+	}
+} // namespace
+
+int main() {
+	CheckPremultiplyReference();
+
+	for(auto level : { SimdLevel::Scalar, SimdLevel::Sse41, SimdLevel::Avx2 }) {
+		const auto& kernels = narwhal::GetPixelKernels(level);
+		if(kernels.level != level) {
+			std::printf("skipping level %d, not supported here\n", static_cast<int>(level));
+			continue;
+		}
+
+		const auto before = failures;
+		CheckPixels(kernels, "bgrx_to_rgba", &PixelKernels::bgrx_to_rgba, 4, 4);
+		CheckPixels(kernels, "rgba_to_bgrx", &PixelKernels::rgba_to_bgrx, 4, 4);
+		CheckPixels(kernels, "rgb565_to_bgrx", &PixelKernels::rgb565_to_bgrx, 2, 4);
+		CheckPixels(kernels, "premultiply_alpha", &PixelKernels::premultiply_alpha, 4, 4);
+		CheckI420(kernels, "rgba_to_i420", &PixelKernels::rgba_to_i420);
+		CheckI420(kernels, "bgrx_to_i420", &PixelKernels::bgrx_to_i420);
+
+		std::printf("%s: %s\n", kernels.name, failures == before ? "ok" : "FAILED");
+	}
+
+	return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,120 @@
+/**
+ * \file Messages related to chat.
+ */
+
+#ifndef LYDIA_CHATMESSAGES_H
+#define LYDIA_CHATMESSAGES_H
+
+#include <binproto/Array.h>
+#include <lydia/messages/LydiaMessage.h>
+#include <lydia/messages/UserMessages.h>
+
+namespace lydia::messages {
+
+	struct ChatChannelReference {
+		enum class Type : std::uint8_t {
+			VMChat, // "public" VM chat
+			Whisper
+		};
+
+		/**
+		 * Channel ID. Always 0 for VMChat (there's one per room).
+		 */
+		std::uint64_t id {};
+		Type type {};
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * A single line of chat.
+	 */
+	struct ChatLine {
+		/**
+		 * The user who sent this line.
+		 */
+		UserReference user;
+
+		ReadableString message;
+
+		/**
+		 * When the line was sent, in milliseconds since the Unix epoch.
+		 */
+		std::uint64_t timestamp {};
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent by the client to say something in a channel.
+	 */
+	struct ChatClientMessage : public Message<MessageOpcode::ChatMessage, ChatClientMessage> {
+		ChatChannelReference channel;
+		ReadableString message;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * One or more lines of chat in a channel.
+	 *
+	 * During bursts, lines sent in the same server tick are batched into one of these.
+	 * The channel history is also sent as one of these when joining a room.
+	 */
+	struct ChatServerMessage : public Message<MessageOpcode::ChatMessage, ChatServerMessage> {
+		ChatChannelReference channel;
+
+		/**
+		 * The lines, oldest first.
+		 */
+		binproto::Array<ChatLine> lines;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent by the client to open a whisper channel with another user in the room.
+	 */
+	struct ChatCreateWhisperChannelClientMessage : public Message<MessageOpcode::ChatCreateWhisperChannel, ChatCreateWhisperChannelClientMessage> {
+		/**
+		 * The user to whisper with. Only the uid is needed.
+		 */
+		UserReference user;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent to both users of a whisper channel when it's opened.
+	 */
+	struct ChatCreateWhisperChannelServerMessage : public Message<MessageOpcode::ChatCreateWhisperChannel, ChatCreateWhisperChannelServerMessage> {
+		ChatChannelReference channel;
+
+		/**
+		 * The other user in the channel.
+		 */
+		UserReference user;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent by the client to close a whisper channel,
+	 * and by the server to both of its users when it's closed.
+	 */
+	struct ChatDeleteWhisperChannelMessage : public Message<MessageOpcode::ChatDeleteWhisperChannel, ChatDeleteWhisperChannelMessage> {
+		ChatChannelReference channel;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+} // namespace lydia::messages
+
+#endif //LYDIA_CHATMESSAGES_H
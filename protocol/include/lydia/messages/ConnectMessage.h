@@ -1,6 +1,7 @@
 #ifndef LYDIA_PROTOCOL_CONNECTMESSAGE_H
 #define LYDIA_PROTOCOL_CONNECTMESSAGE_H
 
+#include <binproto/Array.h>
 #include <lydia/messages/LydiaMessage.h>
 
 namespace lydia::messages {
@@ -19,6 +20,55 @@ namespace lydia::messages {
 		void WritePayload(binproto::BufferWriter& writer) const;
 	};
 
+	/**
+	 * Sent by the server now and then to measure the round trip time.
+	 * The client sends it straight back, unchanged.
+	 */
+	struct PingMessage : public Message<MessageOpcode::Ping, PingMessage> {
+		/**
+		 * Picked by the server to tell its pings apart. Means nothing to the client.
+		 */
+		std::uint64_t nonce {};
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * A piece of a large message, which the server splits up so it doesn't hold up
+	 * smaller, more urgent ones; those may arrive between the pieces, and so may pieces
+	 * of large messages of other streams. The client appends the pieces of each stream
+	 * together, and handles the result as a message once that stream's last one arrives.
+	 */
+	struct ChunkMessage : public Message<MessageOpcode::Chunk, ChunkMessage> {
+		/**
+		 * Which message the piece belongs to. A stream has one message in pieces at a
+		 * time, and its pieces arrive in order.
+		 */
+		std::uint8_t stream {};
+
+		/**
+		 * True if this is the last piece of the message.
+		 */
+		bool last {};
+
+		binproto::ByteArray data;
+
+		/**
+		 * Write everything Write() would put ahead of a piece's data, for a writer sending
+		 * the data straight from where it is instead of copying it into data.
+		 *
+		 * \param[in] size How many bytes of data follow.
+		 */
+		static void WriteHeader(binproto::BufferWriter& writer, std::uint8_t stream, bool last, std::uint32_t size);
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+
+	   private:
+		static void WriteFields(binproto::BufferWriter& writer, std::uint8_t stream, bool last);
+	};
+
 } // namespace lydia::messages
 
 #endif //LYDIA_PROTOCOL_CONNECTMESSAGE_H
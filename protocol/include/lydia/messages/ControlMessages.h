@@ -61,19 +61,54 @@ namespace lydia::messages {
 		void WritePayload(binproto::BufferWriter& writer) const;
 	};
 
+	/**
+	 * A cursor shape.
+	 */
+	struct CursorImage {
+		enum class Encoding : std::uint8_t {
+			Raw, // 32bpp RGBA
+			Zlib // 32bpp RGBA, deflated
+		};
+
+		std::uint16_t width {};
+		std::uint16_t height {};
+
+		/**
+		 * The pixel of the image that points at the cursor position.
+		 */
+		std::uint16_t hotspot_x {};
+		std::uint16_t hotspot_y {};
+
+		Encoding encoding {};
+		binproto::ByteArray data;
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
 	/**
 	 * Sent when the guest updates the cursor image
 	 * with either a capable graphics adapter (for instance QEMU's QXL graphics adapter)
 	 * or the Agent.
+	 *
+	 * Guests switch between a handful of shapes, so clients keep the shapes they've been sent,
+	 * keyed by ID. The image is only sent the first time a client gets a shape.
+	 *
+	 * There are at most 64 IDs, and they're reused: an image sent with an ID replaces
+	 * whatever shape the client had under it.
 	 */
 	struct MouseCursorUpdateMessage : public Message<MessageOpcode::MouseCursorUpdate, MouseCursorUpdateMessage> {
 		bool hidden; // Whether or not the cursor is hidden.
 
 		/**
-		 * The cursor image.
-		 * This is a raw 32bpp RGBA image.
+		 * ID of the cursor shape, from 1 to 64. 0 if hidden.
 		 */
-		binproto::Optional<binproto::ByteArray> cursor_image;
+		std::uint32_t cursor_id {};
+
+		/**
+		 * The cursor image, if the client doesn't have this shape yet.
+		 */
+		binproto::Optional<CursorImage> cursor_image;
 
 		bool ReadPayload(binproto::BufferReader& reader);
 		void WritePayload(binproto::BufferWriter& writer) const;
@@ -105,18 +140,94 @@ namespace lydia::messages {
 	 */
 	struct TurnClientMessage : public MessageWithNoPayload<MessageOpcode::Turn> {};
 
-	// TODO move
-
-	struct ChatChannelReference {
-		enum class Type : std::uint8_t {
-			VMChat, // "public" VM chat
-			Whisper
+	/**
+	 * Sent by a privileged client to administrate the turn queue.
+	 */
+	struct TurnAdministrationMessage : public Message<MessageOpcode::TurnAdministration, TurnAdministrationMessage> {
+		enum class Action : std::uint8_t {
+			/**
+			 * Pause the turn timer.
+			 */
+			Pause,
+
+			/**
+			 * Resume the turn timer.
+			 */
+			Resume,
+
+			/**
+			 * End the current turn early.
+			 */
+			EndTurn,
+
+			/**
+			 * Remove everyone from the turn queue.
+			 */
+			Clear
 		};
 
-		std::uint64_t id;
-		Type type;
+		Action action {};
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
 	};
 
+	/**
+	 * A single change to the turn queue.
+	 *
+	 * Clients are sent a full TurnServerMessage when they join,
+	 * and keep their own copy of the queue up to date with these afterwards.
+	 */
+	struct TurnUpdateMessage : public Message<MessageOpcode::TurnUpdate, TurnUpdateMessage> {
+		enum class Action : std::uint8_t {
+			/**
+			 * The user was added to the end of the queue.
+			 */
+			Enqueued,
+
+			/**
+			 * The user was removed from the queue.
+			 * If they had the turn, the next user in the queue has it now.
+			 */
+			Removed,
+
+			/**
+			 * The queue was paused.
+			 */
+			Paused,
+
+			/**
+			 * The queue was resumed.
+			 */
+			Resumed,
+
+			/**
+			 * The queue was emptied.
+			 */
+			Cleared
+		};
+
+		Action action {};
+
+		/**
+		 * The user this change concerns. Only sent for Enqueued and Removed.
+		 */
+		binproto::Optional<UserReference> user;
+
+		/**
+		 * Time left in the current turn after this change.
+		 */
+		std::uint32_t turn_ms {};
+
+		/**
+		 * The length of a full turn, so the client can work out its own wait time
+		 * from its position in the queue.
+		 */
+		std::uint32_t turn_length_ms {};
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
 
 	NARWHAL_ENUM_IS_FLAG(MouseMessage::Buttons)
 } // namespace lydia::messages
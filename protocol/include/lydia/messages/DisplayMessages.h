@@ -0,0 +1,171 @@
+/**
+ * \file Messages related to the VM display.
+ */
+
+#ifndef LYDIA_DISPLAYMESSAGES_H
+#define LYDIA_DISPLAYMESSAGES_H
+
+#include <binproto/Array.h>
+#include <lydia/messages/LydiaMessage.h>
+
+namespace lydia::messages {
+
+	/**
+	 * A changed rectangle of the VM display.
+	 */
+	struct DisplayRect {
+		/**
+		 * How the rectangle's pixel data is encoded.
+		 */
+		enum class Encoding : std::uint8_t {
+			/**
+			 * Uncompressed 32bpp RGBA, width * height pixels.
+			 */
+			Raw,
+
+			/**
+			 * Raw, compressed with zlib. Used for text-like content.
+			 */
+			Zlib,
+
+			/**
+			 * A JPEG image. Used for photographic content.
+			 */
+			Jpeg,
+
+			/**
+			 * A WebP image, lossy or lossless.
+			 * Used for photographic content, and for everything in Legacy WebP mode.
+			 */
+			WebP
+		};
+
+		std::uint16_t x {};
+		std::uint16_t y {};
+		std::uint16_t width {};
+		std::uint16_t height {};
+
+		Encoding encoding {};
+
+		/**
+		 * Encoded pixel data.
+		 */
+		binproto::ByteArray data;
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * A rectangle of the VM display that moved (e.g. scrolled).
+	 * The client copies the pixels it has at the source to the destination.
+	 */
+	struct CopyRect {
+		std::uint16_t src_x {};
+		std::uint16_t src_y {};
+
+		std::uint16_t x {};
+		std::uint16_t y {};
+		std::uint16_t width {};
+		std::uint16_t height {};
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent to clients when part of the VM display changed.
+	 * All rectangles in one message are from the same captured frame.
+	 */
+	struct RectangleUpdateMessage : public Message<MessageOpcode::RectangleUpdate, RectangleUpdateMessage> {
+		/**
+		 * Moved rectangles. Applied first, in order. Source and destination may overlap,
+		 * in which case the copy must behave as if the source was read before anything was written.
+		 */
+		binproto::Array<CopyRect> copies;
+
+		binproto::Array<DisplayRect> rects;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * A tile of the VM display, and a slot of the client's tile cache.
+	 */
+	struct CachedTile {
+		std::uint32_t slot {};
+
+		std::uint16_t x {};
+		std::uint16_t y {};
+		std::uint16_t width {};
+		std::uint16_t height {};
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Tells the client to draw tiles it already has, and which tiles to keep.
+	 *
+	 * The server decides what goes in which slot, and keeps track of what the client has,
+	 * so the client just keeps an array of tiles indexed by slot.
+	 *
+	 * Sent after the RectangleUpdateMessage of the same frame (if there is one). The client
+	 * first draws every tile in draws from its slot, then copies every tile in stores from
+	 * the display (with that frame's rectangles drawn) into its slot, in order.
+	 */
+	struct TileCacheMessage : public Message<MessageOpcode::TileCache, TileCacheMessage> {
+		binproto::Array<CachedTile> draws;
+		binproto::Array<CachedTile> stores;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * A frame of a video stream of the VM display.
+	 *
+	 * While a VM's display changes a lot (e.g. it's playing a video), the server can switch
+	 * to sending it as a video stream, and sends these instead of RectangleUpdateMessages.
+	 * Each frame covers the whole display; the client scales it to the display's size.
+	 * The first frame of a stream, and of any change in size, is a keyframe.
+	 *
+	 * The next RectangleUpdateMessage ends the stream. It covers the whole display.
+	 */
+	struct VideoFrameMessage : public Message<MessageOpcode::VideoFrame, VideoFrameMessage> {
+		enum class Codec : std::uint8_t {
+			/**
+			 * VP8 (RFC 6386), one frame per message without any container.
+			 */
+			VP8
+		};
+
+		Codec codec {};
+
+		/**
+		 * Size of the encoded video.
+		 */
+		std::uint16_t width {};
+		std::uint16_t height {};
+
+		/**
+		 * True if the frame can be decoded on its own.
+		 */
+		bool keyframe {};
+
+		/**
+		 * When the frame was captured, in milliseconds from some arbitrary start.
+		 * Only the difference between frames means anything.
+		 */
+		std::uint32_t timestamp {};
+
+		binproto::ByteArray data;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
+
+} // namespace lydia::messages
+
+#endif //LYDIA_DISPLAYMESSAGES_H
@@ -29,7 +29,65 @@ namespace lydia::messages {
 		void WritePayload(binproto::BufferWriter& writer) const;
 	};
 
+	/**
+	 * Sent by the client to start (or stop) getting ListUpdateMessages,
+	 * instead of polling with ListMessage.
+	 */
+	struct ListSubscribeMessage : public Message<MessageOpcode::ListSubscribe, ListSubscribeMessage> {
+		bool subscribe {};
+
+		/**
+		 * Version of the list the client already has, or 0 if it has none.
+		 * If the server can't bring that version up to date with changes,
+		 * the client gets the whole list instead.
+		 */
+		std::uint64_t version {};
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
 
+	/**
+	 * A change to a single VM of the list.
+	 */
+	struct ListChange {
+		enum class Type : std::uint8_t {
+			Added, // vm is complete
+			Removed, // only vm.id is set
+			DescriptionChanged, // vm has no preview
+			PreviewChanged // vm has no description
+		};
+
+		Type type {};
+		VMReference vm;
+
+		bool Read(binproto::BufferReader& reader);
+		void Write(binproto::BufferWriter& writer) const;
+	};
+
+	/**
+	 * Sent to subscribed clients when the VM list changes.
+	 */
+	struct ListUpdateMessage : public Message<MessageOpcode::ListUpdate, ListUpdateMessage> {
+		/**
+		 * The version these changes apply to. If it isn't the version the client has,
+		 * the client missed something, and should subscribe again with its version to resync.
+		 *
+		 * 0 means the changes are the whole list (every VM as Added),
+		 * and the client should drop what it has first.
+		 */
+		std::uint64_t base_version {};
+
+		/**
+		 * The version of the list after these changes.
+		 */
+		std::uint64_t version {};
+
+		binproto::Array<ListChange> changes;
+
+		bool ReadPayload(binproto::BufferReader& reader);
+		void WritePayload(binproto::BufferWriter& writer) const;
+	};
 
 }
 
@@ -21,9 +21,24 @@ namespace lydia::messages {
 		Turn,
 		TurnAdministration, // pause turns, such
 
-		ChatCreateWhisperChannel, // TODO
-		ChatDeleteWhisperChannel, // TODO
-		ChatMessage
+		ChatCreateWhisperChannel,
+		ChatDeleteWhisperChannel,
+		ChatMessage,
+
+		TurnUpdate, // incremental turn queue changes
+
+		RectangleUpdate, // framebuffer updates
+
+		ListSubscribe,
+		ListUpdate, // incremental VM list changes
+
+		TileCache, // client-side tile cache draws and stores
+
+		VideoFrame, // video mode framebuffer updates
+
+		Ping, // round trip time measurement
+
+		Chunk // pieces of a large message, interleaved with others
 	};
 
 	/**
@@ -70,6 +85,10 @@ namespace lydia::messages {
 			return underlying_;
 		}
 
+		const std::string& Get() const {
+			return underlying_;
+		}
+
 		explicit operator std::string&() {
 			return Get();
 		}
@@ -0,0 +1,90 @@
+#include <lydia/messages/ChatMessages.h>
+
+namespace lydia::messages {
+
+	bool ChatChannelReference::Read(binproto::BufferReader& reader) {
+		id = reader.ReadUint64();
+		type = static_cast<Type>(reader.ReadByte());
+		return true;
+	}
+
+	void ChatChannelReference::Write(binproto::BufferWriter& writer) const {
+		writer.WriteUint64(id);
+		writer.WriteByte(static_cast<std::uint8_t>(type));
+	}
+
+	bool ChatLine::Read(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(user))
+			return false;
+		if(!reader.ReadMessage(message))
+			return false;
+		timestamp = reader.ReadUint64();
+		return true;
+	}
+
+	void ChatLine::Write(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(user);
+		writer.WriteMessage(message);
+		writer.WriteUint64(timestamp);
+	}
+
+	bool ChatClientMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(channel))
+			return false;
+		if(!reader.ReadMessage(message))
+			return false;
+		return true;
+	}
+
+	void ChatClientMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(channel);
+		writer.WriteMessage(message);
+	}
+
+	bool ChatServerMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(channel))
+			return false;
+		if(!reader.ReadMessage(lines))
+			return false;
+		return true;
+	}
+
+	void ChatServerMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(channel);
+		writer.WriteMessage(lines);
+	}
+
+	bool ChatCreateWhisperChannelClientMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(user))
+			return false;
+		return true;
+	}
+
+	void ChatCreateWhisperChannelClientMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(user);
+	}
+
+	bool ChatCreateWhisperChannelServerMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(channel))
+			return false;
+		if(!reader.ReadMessage(user))
+			return false;
+		return true;
+	}
+
+	void ChatCreateWhisperChannelServerMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(channel);
+		writer.WriteMessage(user);
+	}
+
+	bool ChatDeleteWhisperChannelMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(channel))
+			return false;
+		return true;
+	}
+
+	void ChatDeleteWhisperChannelMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(channel);
+	}
+
+} // namespace lydia::messages
@@ -20,4 +20,39 @@ namespace lydia::messages {
 		writer.WriteByte(success);
 	}
 
+	bool PingMessage::ReadPayload(binproto::BufferReader& reader) {
+		nonce = reader.ReadUint64();
+		return true;
+	}
+
+	void PingMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteUint64(nonce);
+	}
+
+	void ChunkMessage::WriteHeader(binproto::BufferWriter& writer, std::uint8_t stream, bool last, std::uint32_t size) {
+		ChunkMessage {}.header.Write(writer);
+		WriteFields(writer, stream, last);
+
+		// The length prefix data.Write() starts with.
+		writer.WriteUint32(size);
+	}
+
+	bool ChunkMessage::ReadPayload(binproto::BufferReader& reader) {
+		stream = reader.ReadByte();
+		last = reader.ReadByte();
+		if(!reader.ReadMessage(data))
+			return false;
+		return true;
+	}
+
+	void ChunkMessage::WritePayload(binproto::BufferWriter& writer) const {
+		WriteFields(writer, stream, last);
+		writer.WriteMessage(data);
+	}
+
+	void ChunkMessage::WriteFields(binproto::BufferWriter& writer, std::uint8_t stream, bool last) {
+		writer.WriteByte(stream);
+		writer.WriteByte(last);
+	}
+
 } // namespace lydia::messages
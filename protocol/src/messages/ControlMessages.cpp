@@ -43,14 +43,37 @@ namespace lydia::messages {
 		writer.WriteUint16(y);
 	}
 
+	bool CursorImage::Read(binproto::BufferReader& reader) {
+		width = reader.ReadUint16();
+		height = reader.ReadUint16();
+		hotspot_x = reader.ReadUint16();
+		hotspot_y = reader.ReadUint16();
+		encoding = static_cast<Encoding>(reader.ReadByte());
+		if(!reader.ReadMessage(data))
+			return false;
+		return true;
+	}
+
+	void CursorImage::Write(binproto::BufferWriter& writer) const {
+		writer.WriteUint16(width);
+		writer.WriteUint16(height);
+		writer.WriteUint16(hotspot_x);
+		writer.WriteUint16(hotspot_y);
+		writer.WriteByte(static_cast<std::uint8_t>(encoding));
+		writer.WriteMessage(data);
+	}
+
 	bool MouseCursorUpdateMessage::ReadPayload(binproto::BufferReader& reader) {
 		hidden = reader.ReadByte();
-		reader.ReadMessage(cursor_image);
+		cursor_id = reader.ReadUint32();
+		if(!reader.ReadMessage(cursor_image))
+			return false;
 		return true;
 	}
 
 	void MouseCursorUpdateMessage::WritePayload(binproto::BufferWriter& writer) const {
 		writer.WriteByte(hidden);
+		writer.WriteUint32(cursor_id);
 		writer.WriteMessage(cursor_image);
 	}
 
@@ -67,4 +90,29 @@ namespace lydia::messages {
 		writer.WriteUint32(turn_ms);
 		writer.WriteByte(paused);
 	}
+
+	bool TurnAdministrationMessage::ReadPayload(binproto::BufferReader& reader) {
+		action = static_cast<Action>(reader.ReadByte());
+		return true;
+	}
+
+	void TurnAdministrationMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteByte(static_cast<std::uint8_t>(action));
+	}
+
+	bool TurnUpdateMessage::ReadPayload(binproto::BufferReader& reader) {
+		action = static_cast<Action>(reader.ReadByte());
+		if(!reader.ReadMessage(user))
+			return false;
+		turn_ms = reader.ReadUint32();
+		turn_length_ms = reader.ReadUint32();
+		return true;
+	}
+
+	void TurnUpdateMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteByte(static_cast<std::uint8_t>(action));
+		writer.WriteMessage(user);
+		writer.WriteUint32(turn_ms);
+		writer.WriteUint32(turn_length_ms);
+	}
 } // namespace lydia::messages
\ No newline at end of file
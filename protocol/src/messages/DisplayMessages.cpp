@@ -0,0 +1,107 @@
+#include <lydia/messages/DisplayMessages.h>
+
+namespace lydia::messages {
+
+	bool DisplayRect::Read(binproto::BufferReader& reader) {
+		x = reader.ReadUint16();
+		y = reader.ReadUint16();
+		width = reader.ReadUint16();
+		height = reader.ReadUint16();
+		encoding = static_cast<Encoding>(reader.ReadByte());
+		if(!reader.ReadMessage(data))
+			return false;
+		return true;
+	}
+
+	void DisplayRect::Write(binproto::BufferWriter& writer) const {
+		writer.WriteUint16(x);
+		writer.WriteUint16(y);
+		writer.WriteUint16(width);
+		writer.WriteUint16(height);
+		writer.WriteByte(static_cast<std::uint8_t>(encoding));
+		writer.WriteMessage(data);
+	}
+
+	bool CopyRect::Read(binproto::BufferReader& reader) {
+		src_x = reader.ReadUint16();
+		src_y = reader.ReadUint16();
+		x = reader.ReadUint16();
+		y = reader.ReadUint16();
+		width = reader.ReadUint16();
+		height = reader.ReadUint16();
+		return true;
+	}
+
+	void CopyRect::Write(binproto::BufferWriter& writer) const {
+		writer.WriteUint16(src_x);
+		writer.WriteUint16(src_y);
+		writer.WriteUint16(x);
+		writer.WriteUint16(y);
+		writer.WriteUint16(width);
+		writer.WriteUint16(height);
+	}
+
+	bool RectangleUpdateMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(copies))
+			return false;
+		if(!reader.ReadMessage(rects))
+			return false;
+		return true;
+	}
+
+	void RectangleUpdateMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(copies);
+		writer.WriteMessage(rects);
+	}
+
+	bool CachedTile::Read(binproto::BufferReader& reader) {
+		slot = reader.ReadUint32();
+		x = reader.ReadUint16();
+		y = reader.ReadUint16();
+		width = reader.ReadUint16();
+		height = reader.ReadUint16();
+		return true;
+	}
+
+	void CachedTile::Write(binproto::BufferWriter& writer) const {
+		writer.WriteUint32(slot);
+		writer.WriteUint16(x);
+		writer.WriteUint16(y);
+		writer.WriteUint16(width);
+		writer.WriteUint16(height);
+	}
+
+	bool TileCacheMessage::ReadPayload(binproto::BufferReader& reader) {
+		if(!reader.ReadMessage(draws))
+			return false;
+		if(!reader.ReadMessage(stores))
+			return false;
+		return true;
+	}
+
+	void TileCacheMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteMessage(draws);
+		writer.WriteMessage(stores);
+	}
+
+	bool VideoFrameMessage::ReadPayload(binproto::BufferReader& reader) {
+		codec = static_cast<Codec>(reader.ReadByte());
+		width = reader.ReadUint16();
+		height = reader.ReadUint16();
+		keyframe = reader.ReadByte();
+		timestamp = reader.ReadUint32();
+		if(!reader.ReadMessage(data))
+			return false;
+		return true;
+	}
+
+	void VideoFrameMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteByte(static_cast<std::uint8_t>(codec));
+		writer.WriteUint16(width);
+		writer.WriteUint16(height);
+		writer.WriteByte(keyframe);
+		writer.WriteUint32(timestamp);
+		writer.WriteMessage(data);
+	}
+
+} // namespace lydia::messages
@@ -12,4 +12,41 @@ namespace lydia::messages {
 		writer.WriteMessage(nodes);
 	}
 
+	bool ListSubscribeMessage::ReadPayload(binproto::BufferReader& reader) {
+		subscribe = reader.ReadByte();
+		version = reader.ReadUint64();
+		return true;
+	}
+
+	void ListSubscribeMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteByte(subscribe);
+		writer.WriteUint64(version);
+	}
+
+	bool ListChange::Read(binproto::BufferReader& reader) {
+		type = static_cast<Type>(reader.ReadByte());
+		if(!reader.ReadMessage(vm))
+			return false;
+		return true;
+	}
+
+	void ListChange::Write(binproto::BufferWriter& writer) const {
+		writer.WriteByte(static_cast<std::uint8_t>(type));
+		writer.WriteMessage(vm);
+	}
+
+	bool ListUpdateMessage::ReadPayload(binproto::BufferReader& reader) {
+		base_version = reader.ReadUint64();
+		version = reader.ReadUint64();
+		if(!reader.ReadMessage(changes))
+			return false;
+		return true;
+	}
+
+	void ListUpdateMessage::WritePayload(binproto::BufferWriter& writer) const {
+		writer.WriteUint64(base_version);
+		writer.WriteUint64(version);
+		writer.WriteMessage(changes);
+	}
+
 }
\ No newline at end of file
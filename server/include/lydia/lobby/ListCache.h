@@ -0,0 +1,149 @@
+#ifndef LYDIA_LOBBY_LISTCACHE_H
+#define LYDIA_LOBBY_LISTCACHE_H
+
+#include <lydia/messages/ListMessage.h>
+#include <lydia/video/Thumbnailer.h>
+#include <narwhal/RingBuffer.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace lydia::lobby {
+
+	/**
+	 * Serialized ListResponse for the lobby, kept ready to send.
+	 *
+	 * Each VM's VMReference is serialized once, and again only when its description
+	 * or preview changes. The full response is stitched together from those fragments
+	 * the first time it's asked for after a change, and then handed out as a shared buffer,
+	 * so answering a ListMessage doesn't serialize or copy anything.
+	 *
+	 * Every change also goes into a short history, from which GetUpdate() builds the
+	 * ListUpdateMessage bringing a subscriber from its version up to the current one.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the lobby's event thread.
+	 * Previews are the exception: they're encoded elsewhere, and picked up by Refresh().
+	 */
+	struct ListCache {
+		using Buffer = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+		/**
+		 * How many changes are remembered for GetUpdate().
+		 * Subscribers further behind than this get the whole list again.
+		 */
+		constexpr static std::size_t HistoryLength = 256;
+
+		/**
+		 * Add a VM to the end of the list, or change the description of a listed one.
+		 *
+		 * \param[in] id The VM's ID.
+		 * \param[in] description The VM's description. Left out of the list if empty.
+		 * \param[in] thumbnail The VM's preview. May be null for VMs without one.
+		 */
+		void Set(const std::string& id, const binproto::Optional<messages::VMDescription>& description, std::shared_ptr<video::Thumbnail> thumbnail = nullptr);
+
+		/**
+		 * Remove a VM from the list.
+		 */
+		void Remove(const std::string& id);
+
+		/**
+		 * Re-serialize the VMs whose previews were updated since the last call.
+		 * Called by Get(); only needed on its own to see the new version.
+		 *
+		 * \return True if any preview changed.
+		 */
+		bool Refresh();
+
+		/**
+		 * Get the serialized ListResponse (message header included).
+		 * The buffer is never changed; a change to the list makes a new one.
+		 */
+		[[nodiscard]] Buffer Get();
+
+		/**
+		 * Get the serialized ListUpdateMessage bringing a list at some version up to date.
+		 * The last one built is kept, since subscribers are normally all at the same version.
+		 *
+		 * \param[in] since The version the subscriber has (0 for none).
+		 * \return The update, or null if the subscriber is already up to date. Subscribers
+		 * 	   too far behind (or at a version this never had) get the whole list, with base_version 0.
+		 */
+		[[nodiscard]] Buffer GetUpdate(std::uint64_t since);
+
+		/**
+		 * Get the serialized VMReference of one VM, or null if it isn't listed.
+		 */
+		[[nodiscard]] Buffer GetReference(const std::string& id) const;
+
+		/**
+		 * Get the version of the list. It goes up with every change to what Get() returns.
+		 */
+		[[nodiscard]] std::uint64_t GetVersion() const;
+
+		[[nodiscard]] std::size_t Size() const;
+
+	   private:
+		struct Entry {
+			std::string id;
+			binproto::Optional<messages::VMDescription> description;
+			std::shared_ptr<video::Thumbnail> thumbnail;
+
+			/**
+			 * Preview version the fragment was serialized with.
+			 */
+			std::uint64_t preview_version {};
+
+			/**
+			 * The serialized VMReference.
+			 */
+			Buffer fragment;
+		};
+
+		struct Change {
+			std::uint64_t version {};
+			messages::ListChange::Type type {};
+			std::string id;
+		};
+
+		Entry* Find(const std::string& id);
+		const Entry* Find(const std::string& id) const;
+
+		static void Serialize(Entry& entry);
+
+		/**
+		 * Serialize the change of one VM for an update, appending it to out.
+		 * The entry is null for removed VMs.
+		 */
+		static void SerializeChange(messages::ListChange::Type type, const std::string& id, const Entry* entry, std::vector<std::uint8_t>& out);
+
+		/**
+		 * Note a change to the list, dropping the stitched response and update.
+		 */
+		void Record(messages::ListChange::Type type, const std::string& id);
+
+		/**
+		 * VMs, in listing order.
+		 */
+		std::vector<Entry> entries_;
+
+		/**
+		 * The stitched response; null if it needs to be redone.
+		 */
+		Buffer response_;
+		std::uint64_t version_ {};
+
+		narwhal::RingBuffer<Change> history_ { HistoryLength };
+
+		/**
+		 * The last update built, and the version it starts from.
+		 */
+		Buffer update_;
+		std::uint64_t update_since_ {};
+	};
+
+} // namespace lydia::lobby
+
+#endif //LYDIA_LOBBY_LISTCACHE_H
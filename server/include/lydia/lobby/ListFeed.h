@@ -0,0 +1,71 @@
+#ifndef LYDIA_LOBBY_LISTFEED_H
+#define LYDIA_LOBBY_LISTFEED_H
+
+#include <lydia/lobby/ListCache.h>
+#include <lydia/messages/ListMessage.h>
+
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+
+namespace lydia::lobby {
+
+	/**
+	 * Pushes VM list changes to lobby clients that subscribed to them,
+	 * so they don't have to keep polling with ListMessage.
+	 *
+	 * Changes are gathered until the next Tick(), then sent as one ListUpdateMessage.
+	 * Subscribers at the same version (normally all of them) get the very same buffer,
+	 * and when nothing changed, nothing is sent at all.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the lobby's event thread,
+	 * along with the ListCache.
+	 */
+	struct ListFeed {
+		/**
+		 * Function called to send a serialized message to a connection.
+		 */
+		using SendFunction = std::function<void(std::uint64_t, const ListCache::Buffer&)>;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] cache The list. Must outlive this.
+		 * \param[in] send Function to send updates.
+		 */
+		ListFeed(ListCache& cache, SendFunction send);
+
+		/**
+		 * Handle a ListSubscribeMessage from a connection. Subscribing sends
+		 * whatever the connection is missing right away.
+		 *
+		 * \param[in] cid The connection.
+		 * \param[in] message The message.
+		 */
+		void Handle(std::uint64_t cid, const messages::ListSubscribeMessage& message);
+
+		/**
+		 * Forget a connection, e.g. once it closes.
+		 */
+		void Remove(std::uint64_t cid);
+
+		/**
+		 * Send the changes since the last tick to every subscriber.
+		 */
+		void Tick();
+
+		[[nodiscard]] std::size_t SubscriberCount() const;
+
+	   private:
+		ListCache& cache_;
+		SendFunction send_;
+
+		/**
+		 * Subscribed connections, and the version each of them has.
+		 */
+		std::unordered_map<std::uint64_t, std::uint64_t> subscribers_;
+	};
+
+} // namespace lydia::lobby
+
+#endif //LYDIA_LOBBY_LISTFEED_H
@@ -0,0 +1,102 @@
+#ifndef LYDIA_NET_EVENTLOOP_H
+#define LYDIA_NET_EVENTLOOP_H
+
+#include <narwhal/TimerWheel.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+namespace lydia::net {
+
+	/**
+	 * A single-threaded epoll event loop.
+	 *
+	 * Timers are kept in a narwhal::TimerWheel; the loop sleeps in epoll_wait()
+	 * for at most as long as the wheel says it can, so nothing has to poll for timeouts.
+	 *
+	 * Everything except Stop() must be called from the thread running the loop.
+	 */
+	struct EventLoop {
+		/**
+		 * Function called when a file descriptor is ready. Gets the epoll event mask.
+		 */
+		using IoFunction = std::function<void(std::uint32_t events)>;
+
+		/**
+		 * Constructor. Throws std::system_error if the epoll instance can't be created.
+		 */
+		EventLoop();
+
+		EventLoop(const EventLoop&) = delete;
+		EventLoop& operator=(const EventLoop&) = delete;
+
+		~EventLoop();
+
+		/**
+		 * Start watching a file descriptor.
+		 * Throws std::system_error on failure.
+		 *
+		 * \param[in] fd The file descriptor.
+		 * \param[in] events The epoll events to watch for.
+		 * \param[in] function Function called when the fd is ready.
+		 */
+		void Add(int fd, std::uint32_t events, IoFunction function);
+
+		/**
+		 * Change the events watched for on a file descriptor.
+		 * Throws std::system_error on failure.
+		 */
+		void Modify(int fd, std::uint32_t events);
+
+		/**
+		 * Stop watching a file descriptor. Safe to call from inside its own IoFunction.
+		 */
+		void Remove(int fd);
+
+		/**
+		 * Get this loop's timer wheel.
+		 */
+		narwhal::TimerWheel& GetTimers();
+
+		/**
+		 * Wait for I/O or the next timer (whichever comes first), then dispatch.
+		 *
+		 * \param[in] max_wait_ms The longest to wait if no timer is due sooner; -1 for no limit.
+		 */
+		void RunOnce(int max_wait_ms = -1);
+
+		/**
+		 * Run until Stop() is called.
+		 */
+		void Run();
+
+		/**
+		 * Ask the loop to stop. Can be called from any thread.
+		 */
+		void Stop();
+
+	   private:
+		int epoll_fd_ { -1 };
+
+		/**
+		 * eventfd used to wake the loop up from Stop().
+		 */
+		int wake_fd_ { -1 };
+
+		std::atomic_bool should_run_ {};
+
+		narwhal::TimerWheel timers_;
+
+		/**
+		 * Registered I/O functions. These are held by shared_ptr so a function
+		 * can safely remove its own fd while it's running.
+		 */
+		std::unordered_map<int, std::shared_ptr<IoFunction>> functions_;
+	};
+
+} // namespace lydia::net
+
+#endif //LYDIA_NET_EVENTLOOP_H
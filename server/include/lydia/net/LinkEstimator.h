@@ -0,0 +1,135 @@
+#ifndef LYDIA_NET_LINKESTIMATOR_H
+#define LYDIA_NET_LINKESTIMATOR_H
+
+#include <lydia/messages/ConnectMessage.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+namespace lydia::net {
+
+	/**
+	 * Estimates how fast one connection can take data, and its round trip time.
+	 *
+	 * Throughput comes from how fast the send queue drains while it's backed up, which is
+	 * the rate the link really delivers at. A connection that never backs up is never slowed
+	 * by its link, so for those it comes from the kernel's congestion window instead
+	 * (cwnd * mss / rtt, from TCP_INFO). The round trip time is smoothed like TCP does it
+	 * (RFC 6298), from the kernel's estimate and from PingMessage round trips, which also
+	 * count the time spent in our own queues.
+	 *
+	 * The On*() functions and Poll() are expected to be called by the connection's event thread.
+	 * The getters can be called from any thread, and never lock; each value is consistent
+	 * on its own, but two read one after the other may be from different updates.
+	 */
+	struct LinkEstimator {
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Shortest time the send queue must be backed up for to take a throughput sample...
+		 */
+		constexpr static std::chrono::milliseconds MinSample { 100 };
+
+		/**
+		 * ...and the longest one sample covers, so a queue that stays backed up still gives samples.
+		 */
+		constexpr static std::chrono::milliseconds MaxSample { 500 };
+
+		/**
+		 * How long after the last send queue sample the congestion window is used instead.
+		 */
+		constexpr static std::chrono::milliseconds DrainTimeout { 2000 };
+
+		/**
+		 * Account for a write to the socket.
+		 *
+		 * \param[in] written Bytes the socket took.
+		 * \param[in] remaining Bytes still in the send queue afterwards.
+		 */
+		void OnWrite(std::size_t written, std::size_t remaining, Clock::time_point now = Clock::now());
+
+		/**
+		 * Read the kernel's estimates for a TCP socket. Meant to be called every second or so.
+		 *
+		 * \return False if they couldn't be read (not Linux, or not a TCP socket).
+		 */
+		bool Poll(int fd, Clock::time_point now = Clock::now());
+
+		/**
+		 * Make a ping to send to the connection. Only the latest one made counts when it
+		 * comes back.
+		 */
+		[[nodiscard]] messages::PingMessage MakePing(Clock::time_point now = Clock::now());
+
+		/**
+		 * Account for a ping the connection sent back.
+		 *
+		 * The round trip is timed from when the server made the ping, which the client never
+		 * sees; anything but the latest ping's random nonce, echoed once, is ignored. So a
+		 * client can only make its round trip time look longer (by answering late), not shorter.
+		 */
+		void OnPing(const messages::PingMessage& message, Clock::time_point now = Clock::now());
+
+		/**
+		 * Account for a round trip time measured some other way.
+		 */
+		void OnRtt(std::chrono::microseconds rtt);
+
+		/**
+		 * Get the smoothed throughput, in bytes per second. 0 until there's a sample.
+		 */
+		[[nodiscard]] double GetThroughput() const;
+
+		/**
+		 * Get the smoothed round trip time. 0 until there's a sample.
+		 */
+		[[nodiscard]] std::chrono::microseconds GetRtt() const;
+
+		/**
+		 * Get how much the round trip time varies (mean deviation).
+		 */
+		[[nodiscard]] std::chrono::microseconds GetRttVariance() const;
+
+	   private:
+		void OnThroughput(double bytes_per_second);
+
+		/**
+		 * Take a throughput sample of the current backed up period, if it's long enough.
+		 */
+		void Sample(Clock::time_point now);
+
+		// Only touched by the event thread.
+
+		/**
+		 * When the send queue backed up, or the epoch if it isn't; and what was written since.
+		 */
+		Clock::time_point backed_up_ {};
+		std::size_t backed_up_bytes_ {};
+
+		Clock::time_point last_sample_ {};
+
+		bool has_rtt_ {};
+		double srtt_ {};
+		double rttvar_ {};
+
+		/**
+		 * The ping waiting to come back, if any, and when it was made.
+		 */
+		std::mt19937_64 random_ { std::random_device {}() };
+		std::uint64_t ping_nonce_ {};
+		Clock::time_point ping_sent_ {};
+		bool ping_pending_ {};
+
+		// Read by anyone.
+
+		std::atomic<double> throughput_ {};
+		std::atomic<std::int64_t> rtt_ {};
+		std::atomic<std::int64_t> rtt_variance_ {};
+	};
+
+} // namespace lydia::net
+
+#endif //LYDIA_NET_LINKESTIMATOR_H
@@ -0,0 +1,199 @@
+#ifndef LYDIA_NET_SENDQUEUE_H
+#define LYDIA_NET_SENDQUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace lydia::net {
+
+	/**
+	 * A connection's queue of serialized messages waiting to be written, with a cap on
+	 * how much it holds, so a stalled client can't make the server buffer without limit.
+	 *
+	 * Each message is pushed with a policy saying what to do when the client is behind:
+	 *
+	 * - Deliver: user, turn and chat messages, which must all arrive, in order.
+	 * - Supersede: mouse positions, cursors and the like, where only the newest matters.
+	 *   A new one replaces the queued one with the same key, in its place in the queue.
+	 * - Stream: display updates, each building on the one before. Past the soft limit they're
+	 *   dropped, and so is the rest of the stream until a sync (self-contained) message, which
+	 *   the caller should then ask for. A sync message also drops the stream's queued messages,
+	 *   and is queued whatever its size, up to the hard limit.
+	 *
+	 * Past the hard limit, the connection is too far behind to ever catch up; Push() says
+	 * so, and the caller should close it.
+	 *
+	 * Buffers are shared, not copied, so broadcasting one message to every connection costs
+	 * a pointer per connection. This is not thread-safe; it is expected to be owned by the
+	 * connection's event thread.
+	 */
+	struct SendQueue {
+		using Buffer = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+		enum class Policy : std::uint8_t {
+			Deliver,
+			Supersede,
+			Stream
+		};
+
+		enum class Result : std::uint8_t {
+			/**
+			 * The message was queued.
+			 */
+			Queued,
+
+			/**
+			 * The message took the place of a queued one.
+			 */
+			Replaced,
+
+			/**
+			 * The message was dropped; its stream needs a sync message.
+			 */
+			Dropped,
+
+			/**
+			 * The queue is over the hard limit. The message wasn't queued, and the connection should be closed.
+			 */
+			Overflow
+		};
+
+		struct Settings {
+			/**
+			 * Queued bytes past which stream messages, other than sync ones, are dropped.
+			 */
+			std::size_t soft_limit { 1024 * 1024 };
+
+			/**
+			 * Queued bytes past which the connection has overflowed.
+			 */
+			std::size_t hard_limit { 8 * 1024 * 1024 };
+		};
+
+		/**
+		 * Part of a message.
+		 */
+		struct Slice {
+			Buffer buffer;
+			std::size_t offset {};
+			std::size_t size {};
+		};
+
+		SendQueue();
+
+		explicit SendQueue(Settings settings);
+
+		/**
+		 * Queue a message.
+		 *
+		 * \param[in] buffer The serialized message. Must not be null.
+		 * \param[in] policy What to do when the client is behind.
+		 * \param[in] key For Supersede and Stream, which messages replace or follow each other (e.g. opcode and user ID).
+		 * \param[in] sync For Stream, whether the message is self-contained (a full refresh or keyframe).
+		 */
+		Result Push(Buffer buffer, Policy policy = Policy::Deliver, std::uint64_t key = 0, bool sync = false);
+
+		/**
+		 * Get the unsent part of the first message. Empty if the queue is.
+		 */
+		[[nodiscard]] std::span<const std::uint8_t> Front() const;
+
+		/**
+		 * Account for bytes having been written, from the front of the queue.
+		 */
+		void Consume(std::size_t bytes);
+
+		/**
+		 * Take up to some bytes off the front of the queue, to be written later. The rest of a
+		 * message taken in part stays in place, and can't be replaced or dropped anymore.
+		 *
+		 * \param[in] max Most bytes to take.
+		 * \return The first message and the part of it taken. Null if the queue is empty.
+		 */
+		Slice Take(std::size_t max);
+
+		[[nodiscard]] bool Empty() const;
+
+		/**
+		 * Get how many bytes are queued, not counting what's already been written.
+		 */
+		[[nodiscard]] std::size_t Bytes() const;
+
+		/**
+		 * Get how many messages are queued.
+		 */
+		[[nodiscard]] std::size_t Size() const;
+
+		/**
+		 * Get if a stream is dropping messages until a sync message.
+		 */
+		[[nodiscard]] bool NeedsSync(std::uint64_t key) const;
+
+		/**
+		 * Get if the queue ever overflowed.
+		 */
+		[[nodiscard]] bool Overflowed() const;
+
+		void Clear();
+
+	   private:
+		struct Entry {
+			/**
+			 * Null for messages removed from the middle of the queue.
+			 */
+			Buffer buffer;
+			Policy policy {};
+			std::uint64_t key {};
+		};
+
+		/**
+		 * Get the position of a message by its sequence number.
+		 */
+		[[nodiscard]] std::size_t IndexOf(std::uint64_t sequence) const;
+
+		void Remove(Entry& entry);
+
+		/**
+		 * Pop removed messages off the front.
+		 */
+		void Trim();
+
+		Settings settings_;
+
+		std::deque<Entry> entries_;
+
+		/**
+		 * Sequence number of entries_.front(); each message gets the next one.
+		 */
+		std::uint64_t front_sequence_ {};
+
+		/**
+		 * How much of the first message has been written.
+		 */
+		std::size_t offset_ {};
+
+		std::size_t bytes_ {};
+		std::size_t size_ {};
+
+		/**
+		 * Sequence number of the queued message of each Supersede key.
+		 */
+		std::unordered_map<std::uint64_t, std::uint64_t> latest_;
+
+		/**
+		 * Stream keys dropping messages until a sync.
+		 */
+		std::unordered_set<std::uint64_t> dropping_;
+
+		bool overflowed_ {};
+	};
+
+} // namespace lydia::net
+
+#endif //LYDIA_NET_SENDQUEUE_H
@@ -0,0 +1,162 @@
+#ifndef LYDIA_NET_SENDSCHEDULER_H
+#define LYDIA_NET_SENDSCHEDULER_H
+
+#include <lydia/messages/LydiaMessage.h>
+#include <lydia/net/SendQueue.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <span>
+
+#include <sys/uio.h>
+
+namespace lydia::net {
+
+	/**
+	 * Decides in what order a connection's queued messages are written, so input acks,
+	 * turn changes and mouse moves don't wait behind a framebuffer update or a list
+	 * with previews.
+	 *
+	 * Messages go in lanes by how urgent they are, each a SendQueue of its own. The most
+	 * urgent lane with something queued goes first; but a lane that's been waiting while
+	 * fair_share bytes of more urgent ones were written gets the next turn, so nothing is
+	 * held up forever. Messages larger than chunk_size are written as ChunkMessages, one
+	 * piece per turn, so an urgent message only ever waits for what's already been taken
+	 * to be written: one piece from Front(), or one batch from Gather(). Large messages
+	 * of different lanes can be in pieces at the same time, so each lane's pieces carry
+	 * the lane as their stream.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the connection's event thread.
+	 */
+	struct SendScheduler {
+		using Buffer = SendQueue::Buffer;
+
+		/**
+		 * The lanes, most urgent first.
+		 */
+		enum class Lane : std::uint8_t {
+			/**
+			 * Input, turns, mouse and cursor.
+			 */
+			Urgent,
+
+			/**
+			 * Users, chat and list changes.
+			 */
+			Interactive,
+
+			/**
+			 * Display updates and full lists.
+			 */
+			Bulk
+		};
+
+		constexpr static std::size_t LaneCount = 3;
+
+		struct Settings {
+			/**
+			 * Limits of each lane.
+			 */
+			SendQueue::Settings queue;
+
+			/**
+			 * Largest message written whole, and the size of the pieces of larger ones.
+			 */
+			std::size_t chunk_size { 16 * 1024 };
+
+			/**
+			 * How many bytes of more urgent lanes a waiting lane lets go first before it gets a turn.
+			 */
+			std::size_t fair_share { 64 * 1024 };
+		};
+
+		SendScheduler();
+
+		explicit SendScheduler(Settings settings);
+
+		/**
+		 * Get the lane a message normally goes in.
+		 */
+		[[nodiscard]] static Lane LaneOf(messages::MessageOpcode opcode);
+
+		/**
+		 * Queue a message in a lane. See SendQueue::Push().
+		 */
+		SendQueue::Result Push(Lane lane, Buffer buffer, SendQueue::Policy policy = SendQueue::Policy::Deliver, std::uint64_t key = 0, bool sync = false);
+
+		/**
+		 * Get the next bytes to write. Empty if there are none.
+		 */
+		[[nodiscard]] std::span<const std::uint8_t> Front();
+
+		/**
+		 * Get the next bytes to write, as many pieces as fit, for one writev()/sendmsg().
+		 *
+		 * Pieces are taken off the lanes as they're gathered, so the order they go in
+		 * is settled from then on; max_bytes bounds how long something queued after
+		 * may have to wait.
+		 *
+		 * \param[out] out Where to put the pieces.
+		 * \param[in] max_bytes Gather no more pieces once this many bytes are gathered.
+		 * \return How many entries of out were filled in.
+		 */
+		std::size_t Gather(std::span<iovec> out, std::size_t max_bytes);
+
+		/**
+		 * Account for bytes having been written, from what Front() or Gather() gave.
+		 */
+		void Consume(std::size_t bytes);
+
+		[[nodiscard]] bool Empty() const;
+
+		/**
+		 * Get how many bytes are queued in all lanes.
+		 */
+		[[nodiscard]] std::size_t Bytes() const;
+
+		/**
+		 * Get if any lane overflowed.
+		 */
+		[[nodiscard]] bool Overflowed() const;
+
+		[[nodiscard]] const SendQueue& GetQueue(Lane lane) const;
+
+		void Clear();
+
+	   private:
+		constexpr static std::size_t None = static_cast<std::size_t>(-1);
+
+		/**
+		 * Take the next piece off the lane whose turn it is, into the batch.
+		 *
+		 * \return False if all lanes are empty.
+		 */
+		bool Take();
+
+		Settings settings_;
+
+		std::array<SendQueue, LaneCount> lanes_;
+
+		/**
+		 * Bytes of more urgent lanes taken while each lane was waiting.
+		 */
+		std::array<std::size_t, LaneCount> starved_ {};
+
+		/**
+		 * Whether each lane's first message is being taken in pieces.
+		 */
+		std::array<bool, LaneCount> chunking_ {};
+
+		/**
+		 * Pieces taken off the lanes but not yet (completely) written, in order; chunk headers
+		 * are pieces of their own. Only the first may be partly written, up to its offset.
+		 */
+		std::deque<SendQueue::Slice> batch_;
+		std::size_t batch_bytes_ {};
+	};
+
+} // namespace lydia::net
+
+#endif //LYDIA_NET_SENDSCHEDULER_H
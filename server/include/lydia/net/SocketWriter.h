@@ -0,0 +1,115 @@
+#ifndef LYDIA_NET_SOCKETWRITER_H
+#define LYDIA_NET_SOCKETWRITER_H
+
+#include <lydia/net/LinkEstimator.h>
+#include <lydia/net/SendScheduler.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sys/uio.h>
+
+namespace lydia::net {
+
+	/**
+	 * Writes a connection's queued messages to its socket in as few system calls and
+	 * packets as it can.
+	 *
+	 * Messages pushed during a room tick are only queued; at the end of the tick the room
+	 * calls Flush(), which writes everything with one sendmsg() per gathered batch. All but
+	 * the last batch are sent with MSG_MORE, which corks the socket so the kernel doesn't
+	 * push out a short packet per batch; the last one uncorks it. Send() is the bypass for
+	 * messages that shouldn't wait for the tick to end, like input acks.
+	 *
+	 * Whatever the socket doesn't take stays queued; Blocked() says the owner should
+	 * watch for EPOLLOUT and Flush() again once the socket is writable.
+	 *
+	 * The socket isn't owned, and is expected to be non-blocking. This is not thread-safe;
+	 * it is expected to be owned by the connection's event thread.
+	 */
+	struct SocketWriter {
+		using Clock = std::chrono::steady_clock;
+
+		enum class Status : std::uint8_t {
+			/**
+			 * Everything queued was written.
+			 */
+			Done,
+
+			/**
+			 * The socket is full; the rest waits for it to be writable.
+			 */
+			Blocked,
+
+			/**
+			 * Writing failed (e.g. the connection was reset), or the send queue overflowed.
+			 * The connection should be closed.
+			 */
+			Closed
+		};
+
+		struct Settings {
+			SendScheduler::Settings scheduler;
+
+			/**
+			 * Most pieces gathered into one sendmsg(). At least 2, since a piece of a large
+			 * message goes with its chunk header.
+			 */
+			std::size_t max_pieces { 64 };
+
+			/**
+			 * Bytes past which no more pieces are gathered into one sendmsg().
+			 */
+			std::size_t max_batch { 64 * 1024 };
+		};
+
+		explicit SocketWriter(int fd);
+
+		SocketWriter(int fd, Settings settings);
+
+		/**
+		 * Queue a message, to be written on the next Flush(). See SendQueue::Push().
+		 */
+		SendQueue::Result Push(SendScheduler::Lane lane, SendQueue::Buffer buffer, SendQueue::Policy policy = SendQueue::Policy::Deliver, std::uint64_t key = 0, bool sync = false);
+
+		/**
+		 * Queue a message and flush right away, without waiting for the end of the tick.
+		 * Anything else queued goes along, in the scheduler's order.
+		 */
+		Status Send(SendScheduler::Lane lane, SendQueue::Buffer buffer, SendQueue::Policy policy = SendQueue::Policy::Deliver, std::uint64_t key = 0, bool sync = false);
+
+		/**
+		 * Write as much of what's queued as the socket takes.
+		 */
+		Status Flush(Clock::time_point now = Clock::now());
+
+		/**
+		 * Get if the last Flush() left something the socket wouldn't take.
+		 */
+		[[nodiscard]] bool Blocked() const;
+
+		[[nodiscard]] SendScheduler& GetScheduler();
+
+		[[nodiscard]] LinkEstimator& GetEstimator();
+
+	   private:
+		int fd_;
+		Settings settings_;
+
+		SendScheduler scheduler_;
+		LinkEstimator estimator_;
+
+		/**
+		 * Where Flush() gathers pieces into, kept so it doesn't allocate every time.
+		 */
+		std::vector<iovec> pieces_;
+
+		bool blocked_ {};
+		bool closed_ {};
+	};
+
+} // namespace lydia::net
+
+#endif //LYDIA_NET_SOCKETWRITER_H
@@ -0,0 +1,205 @@
+#ifndef LYDIA_ROOM_CHATSERVICE_H
+#define LYDIA_ROOM_CHATSERVICE_H
+
+#include <lydia/messages/ChatMessages.h>
+#include <narwhal/RingBuffer.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * The chat channels of a room: the room's own VM chat, and any whisper channels between its users.
+	 *
+	 * Every channel keeps its recent history in a fixed-size ring buffer, and lines are capped in length,
+	 * so a channel's memory use is bounded no matter how busy the room gets. The ring doubles as the
+	 * outgoing queue: lines posted since the last Tick() are the newest entries in it, and are delivered
+	 * together as a single ChatServerMessage per channel. If a channel gets more lines in one tick than
+	 * it keeps history for, the oldest of them are dropped.
+	 *
+	 * Whisper channels live in a slab with a free list, and their ring buffers are kept for reuse,
+	 * so opening and closing them doesn't allocate once the room has warmed up. Channel IDs carry
+	 * a generation, so an ID for a closed channel never resolves to a channel reusing its slot.
+	 *
+	 * Lines only carry uids; usernames are attached per connection by NameTable::Prepare().
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct ChatService {
+		using Clock = std::chrono::system_clock;
+
+		/**
+		 * Function called to send a message to every user in the room.
+		 */
+		using BroadcastFunction = std::function<void(const messages::ChatServerMessage&)>;
+
+		/**
+		 * Function called to send a message to a single user.
+		 */
+		using SendFunction = std::function<void(std::uint64_t, const messages::ChatServerMessage&)>;
+
+		/**
+		 * Function called to tell a user a whisper channel was opened.
+		 */
+		using WhisperCreatedFunction = std::function<void(std::uint64_t, const messages::ChatCreateWhisperChannelServerMessage&)>;
+
+		/**
+		 * Function called to tell a user a whisper channel was closed.
+		 */
+		using WhisperDeletedFunction = std::function<void(std::uint64_t, const messages::ChatDeleteWhisperChannelMessage&)>;
+
+		/**
+		 * How many lines of history the VM chat keeps.
+		 */
+		constexpr static std::size_t RoomHistoryLength = 100;
+
+		/**
+		 * How many lines of history a whisper channel keeps.
+		 */
+		constexpr static std::size_t WhisperHistoryLength = 32;
+
+		/**
+		 * Longest line allowed, in bytes.
+		 */
+		constexpr static std::size_t MaxMessageLength = 512;
+
+		/**
+		 * How many whisper channels a single user can be in.
+		 */
+		constexpr static std::size_t MaxWhispersPerUser = 16;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] broadcast Function to send VM chat lines.
+		 * \param[in] send Function to send whisper lines.
+		 * \param[in] whisper_created Function to announce opened whisper channels.
+		 * \param[in] whisper_deleted Function to announce closed whisper channels.
+		 */
+		ChatService(BroadcastFunction broadcast, SendFunction send, WhisperCreatedFunction whisper_created, WhisperDeletedFunction whisper_deleted);
+
+		/**
+		 * Post a line of chat. It's delivered on the next Tick().
+		 *
+		 * \return False if the line was rejected: it's empty, too long,
+		 * 	   or for a whisper channel the user isn't in.
+		 */
+		bool Post(std::uint64_t uid, const messages::ChatClientMessage& message, Clock::time_point now = Clock::now());
+
+		/**
+		 * Open a whisper channel between two users, and announce it to both of them.
+		 * If the two already have one open, it's announced again to the user asking.
+		 *
+		 * Permission checks (such as both users being in the room) are up to the caller.
+		 *
+		 * \return The channel, or nothing if either user is in too many channels already.
+		 */
+		std::optional<messages::ChatChannelReference> CreateWhisper(std::uint64_t uid, std::uint64_t peer);
+
+		/**
+		 * Close a whisper channel, and announce it to both of its users.
+		 *
+		 * \return False if the channel doesn't exist or the user isn't in it.
+		 */
+		bool DeleteWhisper(std::uint64_t uid, const messages::ChatChannelReference& channel);
+
+		/**
+		 * Close every whisper channel a user is in, e.g. when they leave the room.
+		 */
+		void RemoveUser(std::uint64_t uid);
+
+		/**
+		 * Deliver the lines posted since the last tick.
+		 */
+		void Tick();
+
+		/**
+		 * Build the VM chat history to send to a user joining the room.
+		 * Lines from users who have since left are sent with just their uid.
+		 */
+		[[nodiscard]] messages::ChatServerMessage MakeHistory() const;
+
+		/**
+		 * Get how many whisper channels are open.
+		 */
+		[[nodiscard]] std::size_t WhisperCount() const;
+
+	   private:
+		struct Line {
+			std::uint64_t uid {};
+			std::string message;
+			std::uint64_t timestamp {};
+		};
+
+		struct Channel {
+			explicit Channel(std::size_t history_length);
+
+			narwhal::RingBuffer<Line> history;
+
+			/**
+			 * Lines posted since the last tick. Never more than history.Size().
+			 */
+			std::size_t pending {};
+
+			/**
+			 * Bumped when a whisper channel is closed, to invalidate its ID.
+			 */
+			std::uint32_t generation {};
+
+			bool used {};
+
+			/**
+			 * The two users of a whisper channel.
+			 */
+			std::uint64_t members[2] {};
+		};
+
+		/**
+		 * Get the whisper channel a reference points to, if it's open and the user is in it.
+		 */
+		Channel* FindWhisper(std::uint64_t uid, const messages::ChatChannelReference& channel);
+
+		/**
+		 * Close a whisper channel by slot, and announce it.
+		 */
+		void CloseWhisper(std::uint32_t index);
+
+		static messages::ChatChannelReference MakeWhisperReference(std::uint32_t index, std::uint32_t generation);
+
+		/**
+		 * Build a message out of the newest lines of a channel.
+		 */
+		static messages::ChatServerMessage MakeMessage(const Channel& channel, const messages::ChatChannelReference& reference, std::size_t count);
+
+		void Push(Channel& channel, std::uint64_t uid, const std::string& message, Clock::time_point now);
+
+		BroadcastFunction broadcast_;
+		SendFunction send_;
+		WhisperCreatedFunction whisper_created_;
+		WhisperDeletedFunction whisper_deleted_;
+
+		Channel room_ { RoomHistoryLength };
+
+		std::vector<Channel> whispers_;
+		std::vector<std::uint32_t> free_;
+
+		/**
+		 * Whisper channel slots each user is in.
+		 */
+		std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> user_whispers_;
+
+		/**
+		 * Whisper channel slots with pending lines.
+		 */
+		std::vector<std::uint32_t> dirty_;
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_CHATSERVICE_H
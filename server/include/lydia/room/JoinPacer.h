@@ -0,0 +1,80 @@
+#ifndef LYDIA_ROOM_JOINPACER_H
+#define LYDIA_ROOM_JOINPACER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * Lets connections into a room at a steady rate, so a herd of them (everyone reconnecting
+	 * at once) doesn't stall the viewers already in it with a burst of full snapshots.
+	 *
+	 * Connections wait in the order they asked, and are let in as a token bucket allows:
+	 * rate per second on average, with up to burst at once after a quiet period.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct JoinPacer {
+		using Clock = std::chrono::steady_clock;
+
+		struct Settings {
+			/**
+			 * Joins let in per second.
+			 */
+			double rate { 20.0 };
+
+			/**
+			 * Most joins let in at once.
+			 */
+			std::size_t burst { 10 };
+		};
+
+		JoinPacer();
+
+		explicit JoinPacer(Settings settings);
+
+		/**
+		 * Have a connection wait to join. Does nothing if it's already waiting.
+		 */
+		void Request(std::uint64_t cid);
+
+		/**
+		 * Stop a connection waiting, e.g. once it closes.
+		 */
+		void Cancel(std::uint64_t cid);
+
+		/**
+		 * Let in the connections whose turn it is. Meant to be called every room tick.
+		 *
+		 * \return The connections let in, in order. Valid until the next call.
+		 */
+		const std::vector<std::uint64_t>& Admit(Clock::time_point now = Clock::now());
+
+		/**
+		 * Get how many connections are waiting.
+		 */
+		[[nodiscard]] std::size_t Waiting() const;
+
+	   private:
+		Settings settings_;
+
+		/**
+		 * Waiting connections, in order. Cancelled ones are only dropped from waiting_, and skipped here later.
+		 */
+		std::deque<std::uint64_t> queue_;
+		std::unordered_set<std::uint64_t> waiting_;
+
+		double tokens_ {};
+		Clock::time_point last_ {};
+
+		std::vector<std::uint64_t> admitted_;
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_JOINPACER_H
@@ -0,0 +1,132 @@
+#ifndef LYDIA_ROOM_JOINSNAPSHOT_H
+#define LYDIA_ROOM_JOINSNAPSHOT_H
+
+#include <lydia/room/KnownNames.h>
+#include <lydia/room/TurnQueue.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * Everything a client joining a room needs, serialized and ready to send: the users
+	 * (in as many messages as it takes to keep each small), the turn queue, the cursor and
+	 * the whole display.
+	 *
+	 * Each part is rebuilt lazily, the first time a snapshot is asked for after it changed,
+	 * so a burst of joins (a VM restart, an edge blip) builds it once and every joiner gets
+	 * the same buffers. The users and the turn queue are followed through their versions;
+	 * the cursor and display come from the room, which says when they changed.
+	 *
+	 * The turn queue part is for a viewer who isn't queued (like anyone joining), and
+	 * since its turn_ms counts down, it's also rebuilt once it's older than turn_max_age.
+	 * Once a snapshot is sent, NameTable::Learn() should be called for the joiner.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct JoinSnapshot {
+		using Clock = std::chrono::steady_clock;
+		using Buffer = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+		/**
+		 * Function building a part of the snapshot. May return null if there's nothing to send.
+		 */
+		using BuildFunction = std::function<Buffer()>;
+
+		struct Settings {
+			/**
+			 * Oldest the turn queue part may get before it's rebuilt anyway.
+			 */
+			std::chrono::milliseconds turn_max_age { 250 };
+
+			/**
+			 * Largest AddUsersMessage the users are split into. Kept under
+			 * SendScheduler::Settings::chunk_size, so they're never written in pieces.
+			 */
+			std::size_t users_size { 8 * 1024 };
+		};
+
+		struct Snapshot {
+			/**
+			 * Goes up every time any part changes.
+			 */
+			std::uint64_t version {};
+
+			/**
+			 * Serialized AddUsersMessages, together listing every user in the room. Sent one
+			 * after the other, more urgent messages can go in between, and the client can
+			 * show the users it has so far.
+			 */
+			std::vector<Buffer> users;
+
+			/**
+			 * Serialized TurnServerMessage, with the username of everyone in it, so it
+			 * doesn't depend on the users part. It goes in the lane of TurnUpdates
+			 * (SendScheduler::LaneOf(), Urgent), before any TurnUpdate for the joiner;
+			 * those then build on it in order.
+			 */
+			Buffer turn;
+
+			/**
+			 * The cursor and the whole display, as built by the room. May be null.
+			 */
+			Buffer cursor;
+			Buffer display;
+		};
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] names The room's users. Must outlive this.
+		 * \param[in] turns The room's turn queue. Must outlive this.
+		 * \param[in] cursor Function to build the cursor part (a self-contained MouseCursorUpdateMessage).
+		 * \param[in] display Function to build the display part (a full refresh).
+		 */
+		JoinSnapshot(const NameTable& names, const TurnQueue& turns, BuildFunction cursor, BuildFunction display);
+
+		JoinSnapshot(const NameTable& names, const TurnQueue& turns, BuildFunction cursor, BuildFunction display, Settings settings);
+
+		/**
+		 * Note the cursor changed; it's rebuilt on the next Get().
+		 */
+		void InvalidateCursor();
+
+		/**
+		 * Note the display changed; it's rebuilt on the next Get().
+		 */
+		void InvalidateDisplay();
+
+		/**
+		 * Get the current snapshot, rebuilding the parts that changed.
+		 * A snapshot is never changed; a change makes a new one.
+		 */
+		[[nodiscard]] std::shared_ptr<const Snapshot> Get(Clock::time_point now = Clock::now());
+
+	   private:
+		const NameTable& names_;
+		const TurnQueue& turns_;
+		BuildFunction build_cursor_;
+		BuildFunction build_display_;
+		Settings settings_;
+
+		std::shared_ptr<const Snapshot> snapshot_;
+
+		/**
+		 * Versions the parts were built at, and when the turn queue part was.
+		 */
+		std::uint64_t names_version_ {};
+		std::uint64_t turns_version_ {};
+		Clock::time_point turn_built_ {};
+
+		bool cursor_stale_ { true };
+		bool display_stale_ { true };
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_JOINSNAPSHOT_H
@@ -0,0 +1,110 @@
+#ifndef LYDIA_ROOM_KNOWNNAMES_H
+#define LYDIA_ROOM_KNOWNNAMES_H
+
+#include <lydia/messages/ChatMessages.h>
+#include <lydia/messages/ControlMessages.h>
+#include <lydia/messages/UserMessages.h>
+#include <lydia/room/UserTable.h>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace lydia::room {
+
+	struct NameTable;
+
+	/**
+	 * Per-connection record of which usernames the client already has in its uid => username cache.
+	 *
+	 * This is a generation-tagged index over a room's UserTable slots: the client knows a
+	 * name if the generation stored for that user's slot matches the slot's current generation.
+	 * It's 4 bytes per user in the room, and renames or slot reuse invalidate it for free.
+	 */
+	struct KnownNames {
+		/**
+		 * Forget everything, e.g. when the connection moves to another room.
+		 */
+		void Clear();
+
+	   private:
+		friend struct NameTable;
+
+		/**
+		 * Generation of the name the client knows, per UserTable slot.
+		 * 0 means the client doesn't know the name.
+		 */
+		std::vector<std::uint32_t> generations_;
+	};
+
+	/**
+	 * The usernames of the users in a room, as the room's connections see them.
+	 *
+	 * The names themselves live in the room's UserTable, which adds, renames and removes
+	 * users; this only reads it, and KnownNames is indexed by its slots.
+	 *
+	 * Engines (the turn queue, chat...) only deal in uids. Outgoing messages are run through
+	 * Prepare() per connection just before serialization, which attaches the username to
+	 * each reference the connection hasn't seen the current name for, and leaves it out otherwise.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct NameTable {
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] users The room's users. Must outlive this.
+		 */
+		explicit NameTable(const UserTable& users);
+
+		/**
+		 * Get the name of a user, or nullptr if they aren't in the room.
+		 */
+		[[nodiscard]] const std::string* Get(std::uint64_t uid) const;
+
+		/**
+		 * Build a reference to a user, with the username attached.
+		 */
+		[[nodiscard]] messages::UserReference MakeReference(std::uint64_t uid) const;
+
+		/**
+		 * Build an AddUsersMessage with every user in the room, usernames attached.
+		 */
+		[[nodiscard]] messages::AddUsersMessage MakeAddUsers() const;
+
+		/**
+		 * Mark every name in the room as known, e.g. after the connection was sent MakeAddUsers().
+		 */
+		void Learn(KnownNames& known) const;
+
+		/**
+		 * Get the version of the names. It goes up with every user added, renamed or removed.
+		 */
+		[[nodiscard]] std::uint64_t GetVersion() const;
+
+		/**
+		 * Fill in or leave out the username of a reference, depending on whether
+		 * the connection already knows it, and mark it as known.
+		 *
+		 * References to users not in the room are left alone.
+		 */
+		void Prepare(KnownNames& known, messages::UserReference& ref) const;
+
+		void Prepare(KnownNames& known, binproto::Array<messages::UserReference>& refs) const;
+
+		// Shorthands for the messages which carry user references.
+
+		void Prepare(KnownNames& known, messages::AddUsersMessage& message) const;
+		void Prepare(KnownNames& known, messages::UserRenameBroadcast& message) const;
+		void Prepare(KnownNames& known, messages::TurnServerMessage& message) const;
+		void Prepare(KnownNames& known, messages::TurnUpdateMessage& message) const;
+		void Prepare(KnownNames& known, messages::ChatServerMessage& message) const;
+		void Prepare(KnownNames& known, messages::ChatCreateWhisperChannelServerMessage& message) const;
+
+	   private:
+		const UserTable& users_;
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_KNOWNNAMES_H
@@ -0,0 +1,107 @@
+#ifndef LYDIA_ROOM_MOUSECOALESCER_H
+#define LYDIA_ROOM_MOUSECOALESCER_H
+
+#include <lydia/messages/ControlMessages.h>
+#include <lydia/room/UserTable.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * Coalesces mouse input for a room.
+	 *
+	 * Clients can send hundreds of MouseMessages a second. Every one is forwarded
+	 * to the hypervisor as soon as it arrives, so the user in control gets no added
+	 * latency, but the position other users see is folded down to the latest one
+	 * per user (kept in the room's UserTable, by slot) and only broadcast once per
+	 * room tick.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct MouseCoalescer {
+		/**
+		 * Function called to inject mouse input into the hypervisor.
+		 */
+		using ForwardFunction = std::function<void(UserTable::Slot slot, const messages::MouseMessage&)>;
+
+		/**
+		 * Function called to fan out a user's latest position to the other users in the room
+		 * (e.g. with UserTable::ForEachConnection(), skipping the slot).
+		 */
+		using BroadcastFunction = std::function<void(UserTable::Slot slot, const messages::MouseMoveMessage&)>;
+
+		/**
+		 * The default tick rate, in Hz.
+		 */
+		constexpr static std::uint32_t DefaultTickRate = 60;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] users The room's users. Must outlive this.
+		 * \param[in] forward Function to forward input to the hypervisor.
+		 * \param[in] broadcast Function to broadcast coalesced movement.
+		 * \param[in] tick_rate Tick rate in Hz.
+		 */
+		MouseCoalescer(UserTable& users, ForwardFunction forward, BroadcastFunction broadcast, std::uint32_t tick_rate = DefaultTickRate);
+
+		/**
+		 * Set the tick rate. A rate of 0 is clamped to 1 Hz.
+		 *
+		 * \param[in] tick_rate Tick rate in Hz.
+		 */
+		void SetTickRate(std::uint32_t tick_rate);
+
+		[[nodiscard]] std::uint32_t GetTickRate() const;
+
+		/**
+		 * Get the interval the owner should call Tick() at.
+		 */
+		[[nodiscard]] std::chrono::nanoseconds GetTickInterval() const;
+
+		/**
+		 * Handle a mouse message from a user: forward it right away, and record the
+		 * position to broadcast on the next tick.
+		 *
+		 * \param[in] slot The user who sent the message.
+		 * \param[in] message The message.
+		 */
+		void OnMouse(UserTable::Slot slot, const messages::MouseMessage& message);
+
+		/**
+		 * Forget about a user, dropping any pending movement.
+		 * Should be called when a user disconnects, before their slot is freed.
+		 */
+		void RemoveUser(UserTable::Slot slot);
+
+		/**
+		 * Broadcast the latest position of every user who moved since the last tick.
+		 */
+		void Tick();
+
+	   private:
+		UserTable& users_;
+
+		ForwardFunction forward_;
+		BroadcastFunction broadcast_;
+
+		std::uint32_t tick_rate_ {};
+
+		/**
+		 * Per slot, true if the latest position has not been broadcast yet.
+		 */
+		std::vector<bool> pending_;
+
+		/**
+		 * Users who moved since the last tick, so Tick() doesn't have to walk the whole room.
+		 */
+		std::vector<UserTable::Slot> dirty_;
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_MOUSECOALESCER_H
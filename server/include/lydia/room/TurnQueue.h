@@ -0,0 +1,185 @@
+#ifndef LYDIA_ROOM_TURNQUEUE_H
+#define LYDIA_ROOM_TURNQUEUE_H
+
+#include <lydia/messages/ControlMessages.h>
+#include <lydia/room/UserTable.h>
+#include <narwhal/TimerWheel.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * The turn queue for a room.
+	 *
+	 * The queue is a doubly linked list threaded through the room's UserTable slots, so
+	 * enqueueing and finding a user are O(1). Each queued user's place is kept in the
+	 * table's turn position column; advancing or removing a user (for instance when they
+	 * disconnect) updates the places of everyone behind them.
+	 *
+	 * Users have to be removed from the queue before they're removed from the table.
+	 *
+	 * The queue doesn't poll. The current turn's deadline is kept in a timer on the
+	 * owning event loop's timer wheel, which is rescheduled whenever the deadline changes.
+	 *
+	 * Changes are announced as small TurnUpdateMessages instead of the whole queue;
+	 * a full TurnServerMessage is only built for clients which just joined.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct TurnQueue {
+		using Clock = narwhal::TimerWheel::Clock;
+
+		/**
+		 * Function called to send a turn update to every user in the room.
+		 */
+		using BroadcastFunction = std::function<void(const messages::TurnUpdateMessage&)>;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] users The room's users. Must outlive this.
+		 * \param[in] timers The timer wheel of the event loop owning this queue.
+		 * \param[in] turn_length The length of a single turn.
+		 * \param[in] broadcast Function to broadcast turn updates.
+		 */
+		TurnQueue(UserTable& users, narwhal::TimerWheel& timers, std::chrono::milliseconds turn_length, BroadcastFunction broadcast);
+
+		/**
+		 * Add a user to the end of the queue.
+		 *
+		 * \return False if the user was already queued, or isn't in the room.
+		 */
+		bool Enqueue(UserTable::Slot slot, Clock::time_point now = Clock::now());
+
+		/**
+		 * Remove a user from the queue, wherever they are in it.
+		 * If the user had the turn, the next user gets it.
+		 *
+		 * \return False if the user wasn't queued.
+		 */
+		bool Remove(UserTable::Slot slot, Clock::time_point now = Clock::now());
+
+		/**
+		 * End the current turn early.
+		 */
+		void EndTurn(Clock::time_point now = Clock::now());
+
+		/**
+		 * Remove everyone from the queue.
+		 */
+		void Clear(Clock::time_point now = Clock::now());
+
+		/**
+		 * Pause the turn timer. The time left in the current turn is kept.
+		 */
+		void Pause(Clock::time_point now = Clock::now());
+
+		/**
+		 * Resume the turn timer.
+		 */
+		void Resume(Clock::time_point now = Clock::now());
+
+		/**
+		 * Apply a TurnAdministrationMessage.
+		 * Permission checks are up to the caller.
+		 */
+		void Administrate(const messages::TurnAdministrationMessage& message, Clock::time_point now = Clock::now());
+
+		[[nodiscard]] bool IsPaused() const;
+
+		[[nodiscard]] bool IsQueued(UserTable::Slot slot) const;
+
+		[[nodiscard]] std::size_t Size() const;
+
+		/**
+		 * Get the uid of the user who currently has the turn, if anyone.
+		 */
+		[[nodiscard]] std::optional<std::uint64_t> Current() const;
+
+		/**
+		 * Build the full turn state for a viewer, e.g. when they join the room.
+		 *
+		 * turn_ms is filled in relative to the viewer: the time until their turn if they are queued,
+		 * or the time until the queue empties if they aren't (or are UserTable::None).
+		 */
+		[[nodiscard]] messages::TurnServerMessage MakeSnapshot(UserTable::Slot viewer, Clock::time_point now = Clock::now()) const;
+
+		/**
+		 * Get the version of the queue. It goes up with every change (every TurnUpdateMessage).
+		 */
+		[[nodiscard]] std::uint64_t GetVersion() const;
+
+	   private:
+		/**
+		 * Links of a slot, UserTable::None at either end. Only meaningful while the slot is queued.
+		 */
+		struct Node {
+			UserTable::Slot prev { UserTable::None };
+			UserTable::Slot next { UserTable::None };
+		};
+
+		/**
+		 * Unlink a slot, and move everyone behind it up a place.
+		 * Returns true if the slot was the head.
+		 */
+		bool Unlink(UserTable::Slot slot);
+
+		/**
+		 * Start the turn of whoever is at the head of the queue.
+		 */
+		void StartTurn(Clock::time_point now);
+
+		/**
+		 * Called when the turn timer fires.
+		 */
+		void OnTimer(Clock::time_point now);
+
+		/**
+		 * Reschedule (or cancel) the turn timer.
+		 */
+		void UpdateTimer();
+
+		[[nodiscard]] std::chrono::milliseconds TimeLeft(Clock::time_point now) const;
+
+		void Broadcast(messages::TurnUpdateMessage::Action action, std::optional<std::uint64_t> uid, Clock::time_point now);
+
+		UserTable& users_;
+
+		std::chrono::milliseconds turn_length_;
+
+		BroadcastFunction broadcast_;
+
+		narwhal::TimerWheel& timers_;
+		narwhal::Timer timer_;
+
+		/**
+		 * Indexed by slot. Grows to the table's capacity as users are queued.
+		 */
+		std::vector<Node> nodes_;
+		UserTable::Slot head_ { UserTable::None };
+		UserTable::Slot tail_ { UserTable::None };
+		std::size_t size_ {};
+
+		bool paused_ {};
+
+		/**
+		 * When the current turn ends. Only meaningful while not paused.
+		 */
+		Clock::time_point deadline_ {};
+
+		/**
+		 * Time left in the current turn. Only meaningful while paused.
+		 */
+		std::chrono::milliseconds paused_left_ {};
+
+		std::uint64_t version_ {};
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_TURNQUEUE_H
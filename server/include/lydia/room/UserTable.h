@@ -0,0 +1,160 @@
+#ifndef LYDIA_ROOM_USERTABLE_H
+#define LYDIA_ROOM_USERTABLE_H
+
+#include <narwhal/EnumBitflagUtils.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lydia::room {
+
+	/**
+	 * Per-user state of the users in a room, as a structure of arrays.
+	 *
+	 * Every user gets a slot, which stays the same as long as they're in the room; slots
+	 * of users who left are reused. Each column is a plain vector indexed by slot, so
+	 * going over everyone (fanning a message out to every connection, say) reads
+	 * contiguous memory, and per-connection state about other users (like KnownNames,
+	 * see NameTable) or per-message state (like who a broadcast skips) can be a vector
+	 * or bitset indexed by slot too. Reuse is told apart by the slot's generation, which
+	 * changes with it.
+	 *
+	 * Free slots have zeroed columns, so column-wide loops can skip them by their
+	 * connection (0) without looking at anything else.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct UserTable {
+		using Slot = std::uint32_t;
+
+		constexpr static Slot None = static_cast<Slot>(-1);
+
+		/**
+		 * What a user may do in the room.
+		 */
+		enum class Permissions : std::uint8_t {
+			None = 0,
+			Turn = narwhal::bit<Permissions, 0>(),
+			Chat = narwhal::bit<Permissions, 1>(),
+			Administrate = narwhal::bit<Permissions, 2>()
+		};
+
+		/**
+		 * Add a user.
+		 *
+		 * \param[in] uid The user's ID.
+		 * \param[in] cid The user's connection. Must not be 0.
+		 * \param[in] username The user's name.
+		 * \return The user's slot, or None if the uid is already in the table or cid is 0.
+		 */
+		Slot Add(std::uint64_t uid, std::uint64_t cid, const std::string& username);
+
+		/**
+		 * Remove a user, freeing their slot.
+		 */
+		void Remove(Slot slot);
+
+		/**
+		 * Get the slot of a user, or None if they aren't in the room.
+		 */
+		[[nodiscard]] Slot Find(std::uint64_t uid) const;
+
+		/**
+		 * Get how many slots there are, used or not. Columns are this long.
+		 */
+		[[nodiscard]] std::size_t Capacity() const;
+
+		/**
+		 * Get how many users there are.
+		 */
+		[[nodiscard]] std::size_t Size() const;
+
+		[[nodiscard]] bool IsUsed(Slot slot) const;
+
+		/**
+		 * Get the version of the table's users. It goes up with every user added, renamed or removed.
+		 */
+		[[nodiscard]] std::uint64_t GetVersion() const;
+
+		/**
+		 * Call a function with every user's slot and connection, except one's (e.g. the sender).
+		 *
+		 * \param[in] except Slot to skip, or None.
+		 */
+		template <class Function>
+		void ForEachConnection(Slot except, Function&& function) const {
+			for(Slot slot = 0; slot < cids_.size(); ++slot) {
+				if(cids_[slot] != 0 && slot != except)
+					function(slot, cids_[slot]);
+			}
+		}
+
+		// Columns. Getters take a used slot.
+
+		[[nodiscard]] std::uint64_t GetUid(Slot slot) const;
+		[[nodiscard]] std::uint64_t GetConnection(Slot slot) const;
+
+		[[nodiscard]] const std::string& GetUsername(Slot slot) const;
+
+		/**
+		 * Rename a user. Changes the slot's generation.
+		 */
+		void SetUsername(Slot slot, const std::string& username);
+
+		/**
+		 * Get the generation of a slot: never 0, and different after a rename or reuse.
+		 */
+		[[nodiscard]] std::uint32_t GetGeneration(Slot slot) const;
+
+		[[nodiscard]] Permissions GetPermissions(Slot slot) const;
+		void SetPermissions(Slot slot, Permissions permissions);
+
+		/**
+		 * Get if a user has all of some permissions.
+		 */
+		[[nodiscard]] bool Can(Slot slot, Permissions permissions) const;
+
+		/**
+		 * Get a user's latest mouse position. Kept up to date by the room's MouseCoalescer.
+		 */
+		[[nodiscard]] std::uint16_t GetCursorX(Slot slot) const;
+		[[nodiscard]] std::uint16_t GetCursorY(Slot slot) const;
+		void SetCursor(Slot slot, std::uint16_t x, std::uint16_t y);
+
+		/**
+		 * Get a user's place in the turn queue (0 has the turn), or nothing if they aren't queued.
+		 * Kept up to date by the room's TurnQueue, which a user has to leave before Remove().
+		 */
+		[[nodiscard]] std::optional<std::uint32_t> GetTurnPosition(Slot slot) const;
+		void SetTurnPosition(Slot slot, std::optional<std::uint32_t> position);
+
+		/**
+		 * Get the connections column, indexed by slot; 0 for free slots.
+		 */
+		[[nodiscard]] std::span<const std::uint64_t> GetConnections() const;
+
+	   private:
+		constexpr static std::uint32_t NotQueued = static_cast<std::uint32_t>(-1);
+
+		std::vector<std::uint64_t> uids_;
+		std::vector<std::uint64_t> cids_;
+		std::vector<std::string> usernames_;
+		std::vector<std::uint32_t> generations_;
+		std::vector<Permissions> permissions_;
+		std::vector<std::uint16_t> cursor_x_;
+		std::vector<std::uint16_t> cursor_y_;
+		std::vector<std::uint32_t> turn_positions_;
+
+		std::vector<Slot> free_;
+		std::unordered_map<std::uint64_t, Slot> slots_;
+		std::uint64_t version_ {};
+	};
+
+} // namespace lydia::room
+
+#endif //LYDIA_ROOM_USERTABLE_H
@@ -0,0 +1,164 @@
+#ifndef LYDIA_USERS_USERNAMEINDEX_H
+#define LYDIA_USERS_USERNAMEINDEX_H
+
+#include <lydia/messages/UserMessages.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace lydia::users {
+
+	/**
+	 * The process-wide index of usernames in use, by guests and registered users alike.
+	 *
+	 * Names are compared by their MakeUsernameKey() key, so a name can't be taken
+	 * again by changing its case or swapping in lookalike characters.
+	 *
+	 * The index is split into shards by key hash. Each shard is an open addressing table
+	 * (linear probing, backward shift deletion) which stores a 128-bit hash of the key
+	 * rather than the key itself, so slots are fixed size and never need to be freed.
+	 *
+	 * Lookups take no locks: they validate against the shard's sequence counter and retry
+	 * if a write raced with them. Writes take a per-shard mutex, so writes to different
+	 * shards never contend. Tables only grow, and grown-out-of tables are kept around until
+	 * the index is destroyed so a racing reader never touches freed memory; geometric growth
+	 * keeps that to less than the size of the live table.
+	 */
+	struct UsernameIndex {
+		using Result = messages::UserRenameResponse::Result;
+
+		/**
+		 * Longest username allowed, in code points.
+		 */
+		constexpr static std::size_t MaxUsernameLength = 32;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] shard_count Number of shards. Rounded up to a power of 2.
+		 */
+		explicit UsernameIndex(std::size_t shard_count = 64);
+
+		UsernameIndex(const UsernameIndex&) = delete;
+		UsernameIndex& operator=(const UsernameIndex&) = delete;
+
+		~UsernameIndex();
+
+		/**
+		 * Claim a username for a user.
+		 *
+		 * Claiming a name the same user already holds (for instance, just changing its case) succeeds.
+		 *
+		 * \param[in] username The username.
+		 * \param[in] uid The user claiming it.
+		 */
+		Result Claim(std::string_view username, std::uint64_t uid);
+
+		/**
+		 * Release a username, if it's held by the given user.
+		 *
+		 * \return True if the name was released.
+		 */
+		bool Release(std::string_view username, std::uint64_t uid);
+
+		/**
+		 * Claim a new username and release the old one.
+		 * The old name is kept if the new one can't be claimed.
+		 */
+		Result Rename(std::string_view from, std::string_view to, std::uint64_t uid);
+
+		/**
+		 * Get the uid of the user holding a username (or one confusable with it), if anyone.
+		 * Never blocks.
+		 */
+		[[nodiscard]] std::optional<std::uint64_t> Owner(std::string_view username) const;
+
+		/**
+		 * Get how many usernames are held.
+		 */
+		[[nodiscard]] std::size_t Size() const;
+
+	   private:
+		struct Hash {
+			std::uint64_t low {};
+			std::uint64_t high {};
+		};
+
+		struct Slot {
+			/**
+			 * Low half of the key hash. 0 means the slot is empty.
+			 */
+			std::atomic<std::uint64_t> low {};
+			std::atomic<std::uint64_t> high {};
+			std::atomic<std::uint64_t> owner {};
+		};
+
+		struct Table {
+			explicit Table(std::size_t capacity);
+
+			std::size_t mask;
+			std::unique_ptr<Slot[]> slots;
+		};
+
+		struct alignas(64) Shard {
+			/**
+			 * Odd while a write is in progress.
+			 */
+			std::atomic<std::uint32_t> sequence {};
+
+			std::atomic<Table*> table {};
+
+			/**
+			 * Serializes writers. Readers never take this.
+			 */
+			std::mutex mutex;
+
+			std::size_t size {};
+
+			/**
+			 * Every table this shard has had, including the current one.
+			 */
+			std::vector<std::unique_ptr<Table>> tables;
+		};
+
+		/**
+		 * Validate a username and hash its key.
+		 */
+		static std::optional<Hash> HashUsername(std::string_view username, Result& result);
+
+		Shard& ShardFor(const Hash& hash) const;
+
+		/**
+		 * Find the slot holding a hash. Only to be used by writers holding the shard lock.
+		 */
+		static Slot* Find(Table& table, const Hash& hash);
+
+		/**
+		 * Insert a hash known not to be in the table. Only to be used by writers holding the shard lock.
+		 */
+		static void Insert(Table& table, const Hash& hash, std::uint64_t uid);
+
+		/**
+		 * Remove a slot, shifting back any slots after it in the same probe run.
+		 */
+		static void Erase(Table& table, Slot* slot);
+
+		/**
+		 * Grow a shard's table if it's getting full. Must hold the shard lock.
+		 */
+		static void MaybeGrow(Shard& shard);
+
+		std::unique_ptr<Shard[]> shards_;
+		std::size_t shard_mask_;
+
+		std::atomic<std::size_t> size_ {};
+	};
+
+} // namespace lydia::users
+
+#endif //LYDIA_USERS_USERNAMEINDEX_H
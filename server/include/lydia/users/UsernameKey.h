@@ -0,0 +1,36 @@
+#ifndef LYDIA_USERS_USERNAMEKEY_H
+#define LYDIA_USERS_USERNAMEKEY_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace lydia::users {
+
+	/**
+	 * Compute the key two usernames are compared by for uniqueness.
+	 *
+	 * Usernames which only differ in case, accents, invisible characters,
+	 * spacing or by swapping in lookalike characters (Cyrillic "а" for Latin "a",
+	 * "0" for "o"...) get the same key. Since case is folded, "i" and "l" have to be
+	 * one class for "I" and "l" to collide, so they are. This follows the idea of
+	 * the UTS #39 confusable skeleton, with hand-maintained tables covering the
+	 * Latin, Greek, Cyrillic and Armenian scripts and fullwidth forms, instead of the full data files.
+	 *
+	 * The key is only for comparison, and should never be shown to anyone.
+	 *
+	 * \param[in] username The username, in UTF-8.
+	 * \return The key, or std::nullopt if the username isn't valid UTF-8
+	 *		   or contains control characters.
+	 */
+	std::optional<std::string> MakeUsernameKey(std::string_view username);
+
+	/**
+	 * Count the code points in a UTF-8 string. Invalid sequences count as one per byte.
+	 */
+	std::size_t CodePointCount(std::string_view string);
+
+} // namespace lydia::users
+
+#endif //LYDIA_USERS_USERNAMEKEY_H
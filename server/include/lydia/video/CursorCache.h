@@ -0,0 +1,123 @@
+#ifndef LYDIA_VIDEO_CURSORCACHE_H
+#define LYDIA_VIDEO_CURSORCACHE_H
+
+#include <lydia/messages/ControlMessages.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lydia::video {
+
+	struct KnownCursors;
+
+	/**
+	 * The cursor shapes of a VM, addressed by content.
+	 *
+	 * Guests flip between a few shapes (arrow, I-beam, busy...) over and over. Each distinct shape
+	 * is hashed, given a small ID and compressed once; clients then get the image the first time
+	 * they see a shape, and just the ID after that (see KnownCursors).
+	 *
+	 * IDs are slots, 1 to MaxCursors, so neither the server nor clients ever keep more than that
+	 * many shapes. Past that, the least recently used shape's slot is given to the new one, with
+	 * a new generation; connections which had the old shape get the new image with the same ID,
+	 * and clients replace what they had under it.
+	 *
+	 * An ID stands for whatever shape is in its slot now, so the VM's current cursor should be the
+	 * ID from the latest Intern(). Being the most recently used, that shape is never the one evicted.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the VM's event thread.
+	 */
+	struct CursorCache {
+		/**
+		 * How many shapes are kept, and the largest ID.
+		 */
+		constexpr static std::size_t MaxCursors = 64;
+
+		/**
+		 * Largest cursor width and height kept. Bigger cursors are clipped to this.
+		 */
+		constexpr static std::uint16_t MaxSize = 256;
+
+		/**
+		 * Look up a cursor shape, adding it if it's new.
+		 *
+		 * \param[in] rgba The image, 32bpp RGBA, width * height pixels.
+		 * \param[in] width Image width.
+		 * \param[in] height Image height.
+		 * \param[in] hotspot_x X of the pixel pointing at the cursor position.
+		 * \param[in] hotspot_y Y of the pixel pointing at the cursor position.
+		 * \return The shape's ID, or 0 if the image is empty.
+		 */
+		std::uint32_t Intern(const std::uint8_t* rgba, std::uint16_t width, std::uint16_t height, std::uint16_t hotspot_x, std::uint16_t hotspot_y);
+
+		/**
+		 * Fill in a cursor update for a connection, attaching the image only if the connection
+		 * doesn't have the shape in that slot yet, and mark it as known.
+		 *
+		 * \param[in] known The connection's known shapes.
+		 * \param[in] id The shape, as returned by Intern(). 0 hides the cursor.
+		 * \param[out] message The message.
+		 * \return False if the ID was never handed out by Intern().
+		 */
+		bool Prepare(KnownCursors& known, std::uint32_t id, messages::MouseCursorUpdateMessage& message) const;
+
+		[[nodiscard]] std::size_t Size() const;
+
+	   private:
+		struct Entry {
+			/**
+			 * Bumped every time the slot gets a new shape. Never 0.
+			 */
+			std::uint32_t generation {};
+
+			std::uint64_t hash {};
+
+			/**
+			 * Uncompressed pixels, to rule out hash collisions.
+			 */
+			std::vector<std::uint8_t> rgba;
+
+			/**
+			 * The image as sent, compressed.
+			 */
+			messages::CursorImage image;
+
+			std::uint64_t last_used {};
+		};
+
+		static void Compress(Entry& entry);
+
+		/**
+		 * Slot i has ID i + 1. Only grows up to MaxCursors.
+		 */
+		std::vector<Entry> entries_;
+
+		/**
+		 * Bumped on every use, for LRU eviction.
+		 */
+		std::uint64_t clock_ {};
+	};
+
+	/**
+	 * Per-connection record of which cursor shapes the client already has.
+	 */
+	struct KnownCursors {
+		/**
+		 * Forget everything, e.g. when the connection moves to another VM.
+		 */
+		void Clear();
+
+	   private:
+		friend struct CursorCache;
+
+		/**
+		 * Generation of the shape the client has, per slot. 0 means it has none.
+		 */
+		std::array<std::uint32_t, CursorCache::MaxCursors> generations_ {};
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_CURSORCACHE_H
@@ -0,0 +1,34 @@
+#ifndef LYDIA_VIDEO_DOWNSAMPLE_H
+#define LYDIA_VIDEO_DOWNSAMPLE_H
+
+#include <lydia/video/Framebuffer.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace lydia::video {
+
+	/**
+	 * Scale a frame down with a box (area averaging) filter.
+	 *
+	 * Each destination pixel is the average of the source pixels it covers, with box edges
+	 * rounded to whole source pixels. This is much cheaper than a proper resampling filter
+	 * and, for the large ratios it's meant for (whole screens down to previews), looks the same.
+	 * Scaling up repeats source pixels.
+	 *
+	 * \param[in] frame The source frame.
+	 * \param[out] out Destination pixels (BGRX), at least height rows of stride bytes.
+	 * \param[in] width Destination width.
+	 * \param[in] height Destination height.
+	 * \param[in] stride Bytes between destination rows.
+	 */
+	void Downsample(const FramebufferView& frame, std::uint8_t* out, std::uint32_t width, std::uint32_t height, std::size_t stride);
+
+	/**
+	 * Get the name of the accumulation kernel Downsample() uses on this machine.
+	 */
+	const char* DownsampleKernelName();
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_DOWNSAMPLE_H
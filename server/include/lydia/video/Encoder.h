@@ -0,0 +1,111 @@
+#ifndef LYDIA_VIDEO_ENCODER_H
+#define LYDIA_VIDEO_ENCODER_H
+
+#include <lydia/messages/DisplayMessages.h>
+#include <lydia/video/Framebuffer.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Encodes rectangles of captured frames for sending to clients.
+	 *
+	 * An Encoder holds the codec state (the zlib stream, the libjpeg compressor and so on)
+	 * and scratch buffers, all set up once and reused for every rectangle. It's not thread-safe:
+	 * the intended use is one Encoder per encoding thread (see EncoderPool).
+	 *
+	 * WebP is only available if the server was built with libwebp.
+	 */
+	struct Encoder {
+		using Encoding = messages::DisplayRect::Encoding;
+
+		struct Settings {
+			/**
+			 * JPEG and lossy WebP quality, 0-100.
+			 */
+			int quality { 75 };
+
+			/**
+			 * Encode everything as WebP (lossless for text-like content),
+			 * for clients in Legacy WebP mode. Ignored without WebP support.
+			 */
+			bool legacy { false };
+
+			/**
+			 * Encode text-like content as lossless WebP, rather than lossy.
+			 * Previews turn this off, since they're small and size matters more there.
+			 */
+			bool lossless_text { true };
+		};
+
+		/**
+		 * Get if this build can encode WebP.
+		 */
+		static bool HasWebP();
+
+		/**
+		 * Get if a rectangle looks like text or UI rather than a photo or video.
+		 *
+		 * Rectangles with few distinct colours or long runs of the same colour are text-like.
+		 * Only a sample of the rectangle's pixels is looked at, so this is cheap.
+		 */
+		static bool IsTextLike(const FramebufferView& frame, const Rect& rect);
+
+		Encoder();
+
+		explicit Encoder(Settings settings);
+
+		Encoder(const Encoder&) = delete;
+		Encoder& operator=(const Encoder&) = delete;
+
+		~Encoder();
+
+		/**
+		 * Pick an encoding for a rectangle by its content.
+		 *
+		 * Text-like rectangles are encoded losslessly (Zlib), photographic ones as JPEG,
+		 * which is several times faster to encode than WebP at similar quality.
+		 * In legacy mode both are WebP, lossless and lossy respectively.
+		 */
+		[[nodiscard]] Encoding ChooseEncoding(const FramebufferView& frame, const Rect& rect) const;
+
+		/**
+		 * Encode a rectangle with the encoding ChooseEncoding() picks for it.
+		 *
+		 * \param[in] frame The frame.
+		 * \param[in] rect The rectangle. Must lie within the frame.
+		 * \param[out] out The encoded rectangle.
+		 */
+		void Encode(const FramebufferView& frame, const Rect& rect, messages::DisplayRect& out);
+
+		/**
+		 * Encode a rectangle with a given encoding. WebP is lossless for text-like rectangles
+		 * (unless lossless_text is off).
+		 * Falls back to Zlib if the encoding isn't available in this build.
+		 */
+		void Encode(const FramebufferView& frame, const Rect& rect, Encoding encoding, messages::DisplayRect& out);
+
+	   private:
+		struct Codecs;
+
+		void EncodeRaw(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out);
+		void EncodeZlib(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out);
+		bool EncodeJpeg(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out);
+		bool EncodeWebP(const FramebufferView& frame, const Rect& rect, bool lossless, std::vector<std::uint8_t>& out);
+
+		Settings settings_;
+
+		std::unique_ptr<Codecs> codecs_;
+
+		/**
+		 * Rectangle converted to RGBA, for the raw based encodings.
+		 */
+		std::vector<std::uint8_t> rgba_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_ENCODER_H
@@ -0,0 +1,130 @@
+#ifndef LYDIA_VIDEO_ENCODERPOOL_H
+#define LYDIA_VIDEO_ENCODERPOOL_H
+
+#include <lydia/messages/DisplayMessages.h>
+#include <lydia/video/Encoder.h>
+#include <lydia/video/Framebuffer.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Encodes the dirty rectangles of captured frames on a pool of worker threads.
+	 *
+	 * Each submitted frame becomes one RectangleUpdateMessage. Its rectangles (split into
+	 * horizontal bands if they're large, so a full screen change spreads over every worker)
+	 * are encoded in parallel, each worker with its own Encoder, and the finished update is
+	 * handed to the done function. Updates are always handed over in the order their frames
+	 * were submitted, even if a later frame finishes encoding first.
+	 *
+	 * Submit() is meant to be called from one thread (the capture or event thread).
+	 * The done function runs on a worker thread; to get back to an event loop, have it Post().
+	 */
+	struct EncoderPool {
+		/**
+		 * Function called with each encoded frame, in submission order.
+		 */
+		using DoneFunction = std::function<void(std::uint64_t sequence, messages::RectangleUpdateMessage& update)>;
+
+		/**
+		 * Rectangles bigger than this many pixels are split into bands.
+		 */
+		constexpr static std::size_t MaxJobArea = 256 * 256;
+
+		/**
+		 * Constructor. Starts the worker threads.
+		 *
+		 * \param[in] threads Number of worker threads. 0 uses one per hardware thread.
+		 * \param[in] settings Settings for each worker's Encoder.
+		 * \param[in] done Function called with encoded frames.
+		 */
+		EncoderPool(std::size_t threads, Encoder::Settings settings, DoneFunction done);
+
+		EncoderPool(const EncoderPool&) = delete;
+		EncoderPool& operator=(const EncoderPool&) = delete;
+
+		/**
+		 * Stops and joins the worker threads. Frames not yet encoded are dropped.
+		 */
+		~EncoderPool();
+
+		/**
+		 * Queue a frame's dirty rectangles for encoding.
+		 *
+		 * \param[in] frame The frame. Kept alive until its rectangles are encoded.
+		 * \param[in] rects The dirty rectangles (e.g. from TileDiff).
+		 * \param[in] copies Moved rectangles (e.g. from ScrollDetector), passed along in the update.
+		 * \return The frame's sequence number, as passed to the done function.
+		 * 	   Frames without any rectangles or copies aren't queued, and get 0.
+		 * 	   A frame with only copies is handed to the done function by this call, once
+		 * 	   the frames before it are.
+		 */
+		std::uint64_t Submit(std::shared_ptr<const Framebuffer> frame, const std::vector<Rect>& rects, const std::vector<messages::CopyRect>& copies = {});
+
+		/**
+		 * Get how many submitted frames haven't been handed to the done function yet.
+		 */
+		[[nodiscard]] std::size_t Pending() const;
+
+		[[nodiscard]] std::size_t ThreadCount() const;
+
+	   private:
+		struct Batch {
+			std::uint64_t sequence {};
+			std::shared_ptr<const Framebuffer> frame;
+			messages::RectangleUpdateMessage update;
+
+			/**
+			 * Rectangles not encoded yet. Guarded by mutex_.
+			 */
+			std::size_t remaining {};
+		};
+
+		struct Job {
+			Batch* batch;
+			std::size_t index;
+			Rect rect;
+		};
+
+		void ThreadEntry();
+
+		/**
+		 * Hand finished frames at the front of the queue to the done function.
+		 */
+		void Deliver();
+
+		Encoder::Settings settings_;
+		DoneFunction done_;
+
+		mutable std::mutex mutex_;
+		std::condition_variable cond_;
+		bool stopping_ {};
+
+		std::deque<Job> jobs_;
+
+		/**
+		 * Frames in submission order.
+		 */
+		std::deque<std::unique_ptr<Batch>> batches_;
+		std::uint64_t next_sequence_ { 1 };
+
+		/**
+		 * Held while taking frames off batches_ and delivering them,
+		 * so two workers can't deliver out of order.
+		 */
+		std::mutex deliver_mutex_;
+
+		std::vector<std::thread> threads_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_ENCODERPOOL_H
@@ -0,0 +1,65 @@
+#ifndef LYDIA_VIDEO_FRAMEBUFFER_H
+#define LYDIA_VIDEO_FRAMEBUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Bytes per pixel of captured frames (32bpp BGRX, as handed out by QEMU and friends).
+	 */
+	constexpr std::size_t BytesPerPixel = 4;
+
+	/**
+	 * A non-owning view over a captured guest frame.
+	 */
+	struct FramebufferView {
+		const std::uint8_t* data {};
+
+		std::uint32_t width {};
+		std::uint32_t height {};
+
+		/**
+		 * Bytes between the start of two rows. At least width * BytesPerPixel.
+		 */
+		std::size_t stride {};
+
+		[[nodiscard]] const std::uint8_t* Row(std::uint32_t y) const {
+			return data + y * stride;
+		}
+	};
+
+	/**
+	 * A captured frame which owns its pixels.
+	 */
+	struct Framebuffer {
+		std::vector<std::uint8_t> data;
+
+		std::uint32_t width {};
+		std::uint32_t height {};
+		std::size_t stride {};
+
+		[[nodiscard]] FramebufferView View() const {
+			return { data.data(), width, height, stride };
+		}
+	};
+
+	/**
+	 * A rectangle of a frame, in pixels.
+	 */
+	struct Rect {
+		std::uint32_t x {};
+		std::uint32_t y {};
+		std::uint32_t width {};
+		std::uint32_t height {};
+
+		[[nodiscard]] std::size_t Area() const {
+			return static_cast<std::size_t>(width) * height;
+		}
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_FRAMEBUFFER_H
@@ -0,0 +1,84 @@
+#ifndef LYDIA_VIDEO_SCROLLDETECTOR_H
+#define LYDIA_VIDEO_SCROLLDETECTOR_H
+
+#include <lydia/messages/DisplayMessages.h>
+#include <lydia/video/Framebuffer.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Finds content that moved between two frames, so scrolling can be sent as a copy
+	 * of pixels the client already has, plus the newly exposed strip.
+	 *
+	 * Each dirty rectangle is checked on its own. For vertical movement, every row of the
+	 * rectangle is hashed in both frames, and each row whose hash is unique in the old frame
+	 * votes for the offset it moved by. The winning offset's longest run of matching rows
+	 * (checked byte for byte, to rule out hash collisions) becomes a copy, and only the rows
+	 * around it are left to encode. Horizontal movement works the same on column hashes,
+	 * which are built up a row at a time so memory is still read in order.
+	 *
+	 * Content that moved out of its dirty rectangle isn't found, but since a scrolled region
+	 * is all dirty, the old position of its content is normally inside the same rectangle.
+	 */
+	struct ScrollDetector {
+		/**
+		 * Rectangles smaller than this in the direction of movement aren't checked.
+		 */
+		constexpr static std::uint32_t MinSize = 64;
+
+		/**
+		 * Fewest rows (or columns) that must have moved for a copy.
+		 */
+		constexpr static std::uint32_t MinMatch = 16;
+
+		/**
+		 * Find moved content in a frame's dirty rectangles.
+		 *
+		 * \param[in] previous The previous frame, i.e. what clients have.
+		 * \param[in] frame The new frame. Nothing is found if its size differs from previous.
+		 * \param[in,out] rects The dirty rectangles. Rectangles with moved content are replaced
+		 * 			by the parts of them that still need encoding.
+		 * \param[out] copies The moved rectangles. Cleared first.
+		 */
+		void Detect(const FramebufferView& previous, const FramebufferView& frame, std::vector<Rect>& rects, std::vector<messages::CopyRect>& copies);
+
+	   private:
+		struct Shift {
+			std::int32_t offset {};
+
+			/**
+			 * The run of rows or columns (in the new frame, relative to the rectangle) that moved.
+			 */
+			std::uint32_t begin {};
+			std::uint32_t end {};
+		};
+
+		bool DetectVertical(const FramebufferView& previous, const FramebufferView& frame, const Rect& rect, std::vector<messages::CopyRect>& copies);
+		bool DetectHorizontal(const FramebufferView& previous, const FramebufferView& frame, const Rect& rect, std::vector<messages::CopyRect>& copies);
+
+		/**
+		 * Find the offset most lines moved by between before_ and after_, and its longest run.
+		 */
+		bool FindShift(Shift& shift);
+
+		// Scratch space, kept between calls.
+
+		std::vector<std::uint64_t> before_;
+		std::vector<std::uint64_t> after_;
+
+		/**
+		 * Line of each hash in before_, or -1 if the hash isn't unique.
+		 */
+		std::unordered_map<std::uint64_t, std::int32_t> lines_;
+		std::vector<std::uint32_t> votes_;
+
+		std::vector<Rect> out_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_SCROLLDETECTOR_H
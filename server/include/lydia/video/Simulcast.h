@@ -0,0 +1,181 @@
+#ifndef LYDIA_VIDEO_SIMULCAST_H
+#define LYDIA_VIDEO_SIMULCAST_H
+
+#include <lydia/video/EncoderPool.h>
+#include <lydia/video/Framebuffer.h>
+#include <lydia/video/TileDiff.h>
+#include <lydia/video/VideoModeSwitch.h>
+#include <lydia/video/VideoStream.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Encodes one VM's display at a few fixed quality tiers, so viewers on slow links
+	 * get a cheaper stream instead of holding everyone else back.
+	 *
+	 * Each tier has its own frame rate and quality, for both rectangle and video mode
+	 * (the mode is decided once for the VM, and all tiers follow it). Every frame of a tier
+	 * is encoded and serialized once, and the same buffer goes to every viewer on that tier,
+	 * so the encoding cost grows with the number of tiers, and not with the number of viewers.
+	 *
+	 * Tiers can only be joined at a sync frame: a full refresh in rectangle mode, or a keyframe
+	 * in video mode. They happen when the mode changes, and when asked for with RequestSync()
+	 * (see TierAssignment, which decides who watches what).
+	 *
+	 * Update() is meant to be called by the thread that diffs the VM's frames.
+	 */
+	struct Simulcast {
+		using Clock = std::chrono::steady_clock;
+		using Buffer = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+		struct Tier {
+			/**
+			 * Most frames sent per second. Changes in between are gathered up into the next frame.
+			 */
+			std::uint32_t framerate { 30 };
+
+			/**
+			 * JPEG and lossy WebP quality in rectangle mode, 0-100.
+			 */
+			int quality { 75 };
+
+			/**
+			 * Video bitrate, in kilobits per second.
+			 */
+			std::uint32_t bitrate { 2500 };
+
+			/**
+			 * Largest video size; 0 for no limit.
+			 */
+			std::uint32_t max_width {};
+			std::uint32_t max_height {};
+
+			/**
+			 * Throughput a viewer needs for this tier, in bytes per second.
+			 */
+			double min_throughput {};
+
+			/**
+			 * Highest round trip time a viewer can have for this tier; 0 for any.
+			 */
+			std::chrono::milliseconds max_rtt {};
+		};
+
+		/**
+		 * Function called with each frame of each tier (message header included), and whether
+		 * it's a sync frame. Called on encoding threads; the frames of one tier are always in order.
+		 */
+		using FrameFunction = std::function<void(std::size_t tier, const Buffer& frame, bool sync)>;
+
+		struct Settings {
+			/**
+			 * The tiers, worst first. Their order is the tier number.
+			 */
+			std::vector<Tier> tiers { DefaultTiers() };
+
+			VideoModeSwitch::Settings mode {};
+
+			/**
+			 * Rectangle encoding threads, shared out between the tiers. 0 uses one per hardware thread.
+			 */
+			std::size_t threads {};
+		};
+
+		/**
+		 * Three tiers: 5 fps at 640x360 video for anyone, 15 fps at 720p for decent links,
+		 * and 30 fps at full size for fast ones.
+		 */
+		static std::vector<Tier> DefaultTiers();
+
+		/**
+		 * Constructor. Starts every tier's encoding threads.
+		 *
+		 * \param[in] settings Settings.
+		 * \param[in] done Function called with encoded frames.
+		 * \param[in] factory Makes video codecs; null for the built-in one.
+		 */
+		Simulcast(Settings settings, FrameFunction done, VideoCodec::Factory factory = nullptr);
+
+		Simulcast(const Simulcast&) = delete;
+		Simulcast& operator=(const Simulcast&) = delete;
+
+		~Simulcast();
+
+		/**
+		 * Hand a diffed frame to every tier that's due for one.
+		 * Should be called for every frame diffed, changed or not.
+		 *
+		 * \param[in] frame The frame that was diffed.
+		 * \param[in] diff The TileDiff the frame was diffed with.
+		 */
+		void Update(const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now = Clock::now());
+
+		/**
+		 * Make the next frame of a tier a sync frame, for a viewer moving to it.
+		 * Can be called from any thread.
+		 */
+		void RequestSync(std::size_t tier);
+
+		[[nodiscard]] std::size_t TierCount() const;
+
+		[[nodiscard]] const Tier& GetTier(std::size_t tier) const;
+
+		[[nodiscard]] bool InVideoMode() const;
+
+	   private:
+		struct TierState {
+			Tier tier;
+
+			std::unique_ptr<EncoderPool> pool;
+			std::unique_ptr<VideoStream> video;
+
+			/**
+			 * Tiles changed since the tier's last frame, in rectangle mode.
+			 */
+			std::vector<std::uint8_t> dirty;
+			Clock::time_point last_submit {};
+
+			std::atomic<bool> sync_requested {};
+
+			/**
+			 * Sequence numbers of full refreshes the pool hasn't delivered yet.
+			 * Held around submitting one, so it's in here before it can be delivered.
+			 */
+			std::mutex sync_mutex;
+			std::vector<std::uint64_t> sync_sequences;
+		};
+
+		/**
+		 * Hand a frame to a tier in rectangle mode.
+		 */
+		void UpdateRects(TierState& state, const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, bool refresh, Clock::time_point now);
+
+		/**
+		 * Called by a tier's pool with an encoded frame.
+		 */
+		void DeliverRects(std::size_t tier, std::uint64_t sequence, const messages::RectangleUpdateMessage& update);
+
+		bool VideoFailed() const;
+
+		FrameFunction done_;
+		VideoModeSwitch switch_;
+
+		std::vector<std::unique_ptr<TierState>> tiers_;
+
+		/**
+		 * Scratch space for merged rects.
+		 */
+		std::vector<Rect> rects_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_SIMULCAST_H
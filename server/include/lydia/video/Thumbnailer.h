@@ -0,0 +1,155 @@
+#ifndef LYDIA_VIDEO_THUMBNAILER_H
+#define LYDIA_VIDEO_THUMBNAILER_H
+
+#include <lydia/video/Framebuffer.h>
+#include <lydia/video/TileDiff.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lydia::video {
+
+	struct Thumbnailer;
+
+	/**
+	 * The cached preview image of one VM, as sent in VMReference::preview_image.
+	 *
+	 * Created by a Thumbnailer, and kept by the VM. Get() can be called from any thread;
+	 * building a list response only copies out the pointer, and never touches pixels.
+	 */
+	struct Thumbnail {
+		using Bytes = std::shared_ptr<const std::vector<std::uint8_t>>;
+
+		/**
+		 * Get the encoded preview. Null until the first one is encoded.
+		 */
+		[[nodiscard]] Bytes Get() const;
+
+		/**
+		 * Get how many previews have been encoded. Changes whenever Get() does.
+		 */
+		[[nodiscard]] std::uint64_t GetVersion() const;
+
+	   private:
+		friend Thumbnailer;
+
+		std::atomic<Bytes> bytes_;
+		std::atomic<std::uint64_t> version_ {};
+
+		// The rest is the Thumbnailer's.
+
+		/**
+		 * Tiles changed since the last preview was queued. Only touched by Update().
+		 */
+		std::vector<std::uint8_t> changed_;
+		std::size_t changed_count_ {};
+		std::chrono::steady_clock::time_point last_queued_;
+
+		/**
+		 * Newest frame waiting to be encoded, and whether this is in the queue. Guarded by the Thumbnailer's mutex.
+		 */
+		std::shared_ptr<const Framebuffer> pending_;
+		bool queued_ {};
+	};
+
+	/**
+	 * Keeps the preview images of VMs up to date.
+	 *
+	 * Frames are scaled down to fit Size x Size (centred, with black bars) and encoded as lossy WebP
+	 * on one background thread running at idle priority, so previews never take time from
+	 * encoding updates for the people actually watching. A VM's preview is only redone
+	 * when a good part of its screen changed since the last one, and not too often;
+	 * a blinking cursor or a clock never causes a re-encode on its own.
+	 *
+	 * Update() is meant to be called by the thread that diffs a VM's frames.
+	 */
+	struct Thumbnailer {
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Width and height of previews.
+		 */
+		constexpr static std::uint32_t Size = 200;
+
+		struct Settings {
+			/**
+			 * Fraction of tiles that must have changed since the last preview for a new one.
+			 */
+			double min_change { 0.1 };
+
+			/**
+			 * Minimum time between two previews of a VM.
+			 */
+			std::chrono::milliseconds min_interval { 5000 };
+
+			/**
+			 * Lossy WebP quality, 0-100.
+			 */
+			int quality { 60 };
+		};
+
+		Thumbnailer();
+
+		explicit Thumbnailer(Settings settings);
+
+		Thumbnailer(const Thumbnailer&) = delete;
+		Thumbnailer& operator=(const Thumbnailer&) = delete;
+
+		/**
+		 * Stops and joins the background thread. Queued previews are dropped.
+		 */
+		~Thumbnailer();
+
+		/**
+		 * Create the preview of a new VM.
+		 */
+		[[nodiscard]] std::shared_ptr<Thumbnail> Create() const;
+
+		/**
+		 * Tell the thumbnailer a VM's frame was diffed, queueing a new preview if enough changed.
+		 * The first frame always gets a preview.
+		 *
+		 * \param[in] thumbnail The VM's preview.
+		 * \param[in] frame The frame that was diffed. Only kept if a preview is queued.
+		 * \param[in] diff The TileDiff the frame was diffed with.
+		 * \return True if a preview was queued (or a queued one given the newer frame).
+		 */
+		bool Update(const std::shared_ptr<Thumbnail>& thumbnail, const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now = Clock::now());
+
+		/**
+		 * Get if this build can encode previews at all (which needs WebP).
+		 */
+		static bool Available();
+
+	   private:
+		void ThreadEntry();
+
+		/**
+		 * Scale a frame into a preview-sized BGRX frame.
+		 */
+		static void Scale(const FramebufferView& frame, Framebuffer& out);
+
+		Settings settings_;
+
+		std::mutex mutex_;
+		std::condition_variable cond_;
+		bool stopping_ {};
+
+		/**
+		 * VMs with a frame waiting, oldest first. Expired ones (VMs gone meanwhile) are skipped.
+		 */
+		std::deque<std::weak_ptr<Thumbnail>> queue_;
+
+		std::thread thread_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_THUMBNAILER_H
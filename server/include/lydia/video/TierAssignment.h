@@ -0,0 +1,132 @@
+#ifndef LYDIA_VIDEO_TIERASSIGNMENT_H
+#define LYDIA_VIDEO_TIERASSIGNMENT_H
+
+#include <lydia/video/Simulcast.h>
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Decides which Simulcast tier each viewer of a VM watches, from how fast their connection is.
+	 *
+	 * A viewer gets the best tier whose throughput and round trip time requirements it meets.
+	 * Dropping to a worse tier happens as soon as it's needed; moving up to a better one only
+	 * once the viewer has had some headroom for a while, so one good measurement doesn't start
+	 * a flip-flop between tiers.
+	 *
+	 * Moving to another tier needs a sync frame of that tier, which is asked for with the sync
+	 * function. Until it comes (Route() is told about it), the viewer stays on its old tier.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the room's event thread.
+	 */
+	struct TierAssignment {
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * Function called to ask for a sync frame of a tier (normally Simulcast::RequestSync()).
+		 */
+		using SyncFunction = std::function<void(std::size_t tier)>;
+
+		struct Settings {
+			/**
+			 * How much more throughput than a better tier needs a viewer must have to move up to it.
+			 */
+			double headroom { 1.25 };
+
+			/**
+			 * How long a viewer must have had that headroom to move up.
+			 */
+			std::chrono::milliseconds upgrade_after { 5000 };
+		};
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] tiers The tiers, worst first, as given to the Simulcast.
+		 * \param[in] sync Function to ask for sync frames.
+		 */
+		TierAssignment(std::vector<Simulcast::Tier> tiers, SyncFunction sync);
+
+		TierAssignment(std::vector<Simulcast::Tier> tiers, Settings settings, SyncFunction sync);
+
+		/**
+		 * Add a viewer. It starts watching at the next sync frame of the tier its estimates pick.
+		 *
+		 * \param[in] cid The connection.
+		 * \param[in] throughput The connection's throughput so far, in bytes per second (0 if unknown).
+		 * \param[in] rtt The connection's round trip time so far (0 if unknown).
+		 */
+		void Add(std::uint64_t cid, double throughput = 0.0, std::chrono::microseconds rtt = {});
+
+		/**
+		 * Update a viewer's estimates, possibly moving it to another tier.
+		 */
+		void Update(std::uint64_t cid, double throughput, std::chrono::microseconds rtt, Clock::time_point now = Clock::now());
+
+		/**
+		 * Forget a viewer, e.g. once it leaves or its connection closes.
+		 */
+		void Remove(std::uint64_t cid);
+
+		/**
+		 * Get who a frame of a tier goes to. If it's a sync frame, the viewers waiting
+		 * for one move onto the tier first.
+		 *
+		 * \return The viewers. Valid until the next call.
+		 */
+		const std::vector<std::uint64_t>& Route(std::size_t tier, bool sync);
+
+		/**
+		 * Get the tier a viewer is watching, or nothing if it isn't watching any yet.
+		 */
+		[[nodiscard]] std::optional<std::size_t> GetTier(std::uint64_t cid) const;
+
+		/**
+		 * Get the tier a viewer is moving to, or nothing if it isn't.
+		 */
+		[[nodiscard]] std::optional<std::size_t> GetTarget(std::uint64_t cid) const;
+
+	   private:
+		constexpr static std::size_t None = static_cast<std::size_t>(-1);
+
+		struct Viewer {
+			std::size_t tier { None };
+			std::size_t target { None };
+
+			/**
+			 * Since when the viewer could have moved up, or the epoch if it couldn't.
+			 */
+			Clock::time_point upgradable {};
+		};
+
+		/**
+		 * Get the best tier a viewer meets the requirements of, with the headroom for tiers above current.
+		 */
+		std::size_t Choose(double throughput, std::chrono::microseconds rtt, std::size_t current) const;
+
+		/**
+		 * Start moving a viewer to a tier (or cancel the move, if it's the one it's on).
+		 */
+		void Retarget(Viewer& viewer, std::size_t tier);
+
+		std::vector<Simulcast::Tier> tiers_;
+		Settings settings_;
+		SyncFunction sync_;
+
+		std::unordered_map<std::uint64_t, Viewer> viewers_;
+
+		/**
+		 * Viewers watching each tier.
+		 */
+		std::vector<std::vector<std::uint64_t>> members_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_TIERASSIGNMENT_H
@@ -0,0 +1,121 @@
+#ifndef LYDIA_VIDEO_TILECACHE_H
+#define LYDIA_VIDEO_TILECACHE_H
+
+#include <lydia/messages/DisplayMessages.h>
+#include <lydia/video/TileDiff.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Server-side mirror of one connection's client-side tile cache.
+	 *
+	 * Guest UIs keep repainting the same things (menus, dialogs, the taskbar), and TileDiff's
+	 * tile hashes don't depend on position, so a dirty tile often has content the client
+	 * already has somewhere. This tracks which tile contents the client holds, in a bounded
+	 * LRU of slots, and turns each frame's dirty tiles into cache draws for content the client
+	 * has, and cache stores for content it's about to get.
+	 *
+	 * Encoding stays shared between viewers: every connection's Plan() marks the tiles it
+	 * needs pixels for, and only the union of those is encoded, e.g.
+	 *
+	 * \code
+	 * diff.Diff(frame);
+	 * std::vector<std::uint8_t> needed(diff.TileCount());
+	 * for(auto& viewer : viewers)
+	 * 	viewer.tiles.Plan(diff, needed, viewer.tile_message);
+	 * diff.MergeTiles(needed, rects);
+	 * pool.Submit(frame, rects);
+	 * \endcode
+	 *
+	 * When every viewer has a tile, it isn't encoded at all.
+	 *
+	 * Tiles are identified by TileDiff's 64-bit hash and their size, so (like any hash based
+	 * cache) a collision would show the wrong tile; with a 64-bit hash that's not a practical concern.
+	 *
+	 * This is not thread-safe; it is expected to be used by the thread handling the VM's frames.
+	 */
+	struct TileCache {
+		/**
+		 * Default number of slots. 4MB of client memory with 32 pixel tiles.
+		 */
+		constexpr static std::uint32_t DefaultCapacity = 1024;
+
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] capacity Number of slots the client keeps.
+		 */
+		explicit TileCache(std::uint32_t capacity = DefaultCapacity);
+
+		/**
+		 * Plan a frame's dirty tiles for this connection.
+		 *
+		 * \param[in] diff The TileDiff the frame was just diffed with.
+		 * \param[in,out] needed Flag per tile, set for tiles this connection needs the pixels of.
+		 * \param[out] message Draws and stores for this connection. Left empty if there are none.
+		 */
+		void Plan(const TileDiff& diff, std::vector<std::uint8_t>& needed, messages::TileCacheMessage& message);
+
+		/**
+		 * Forget everything the client has, e.g. on reconnect.
+		 */
+		void Clear();
+
+		[[nodiscard]] std::uint32_t Capacity() const;
+
+		/**
+		 * Get how many slots are in use.
+		 */
+		[[nodiscard]] std::size_t Size() const;
+
+	   private:
+		constexpr static std::uint32_t None = ~0u;
+
+		struct Slot {
+			std::uint64_t key {};
+
+			/**
+			 * Neighbours in the LRU list, most recently used first.
+			 */
+			std::uint32_t prev { None };
+			std::uint32_t next { None };
+
+			/**
+			 * Plan() call the slot was last stored by.
+			 */
+			std::uint64_t stored {};
+		};
+
+		/**
+		 * Move a slot to the front of the LRU list.
+		 */
+		void Touch(std::uint32_t slot);
+
+		void Unlink(std::uint32_t slot);
+
+		/**
+		 * Take a slot for new content: an unused one, or the least recently used.
+		 */
+		std::uint32_t Allocate(std::uint64_t key);
+
+		std::vector<Slot> slots_;
+		std::unordered_map<std::uint64_t, std::uint32_t> keys_;
+
+		std::uint32_t head_ { None };
+		std::uint32_t tail_ { None };
+
+		/**
+		 * Slots never used yet. Slots are only freed by Clear().
+		 */
+		std::uint32_t unused_ {};
+
+		std::uint64_t frame_ {};
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_TILECACHE_H
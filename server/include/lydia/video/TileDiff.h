@@ -0,0 +1,153 @@
+#ifndef LYDIA_VIDEO_TILEDIFF_H
+#define LYDIA_VIDEO_TILEDIFF_H
+
+#include <lydia/video/Framebuffer.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * Finds what changed between captured frames of a VM display.
+	 *
+	 * The frame is split into square tiles, and each tile is reduced to a 64-bit content hash
+	 * which is compared against the tile's hash from the previous frame. Keeping hashes instead
+	 * of a copy of the previous frame halves the memory traffic of a diff (a frame is only read,
+	 * never compared against or copied into a second 8MB buffer), which is what bounds it.
+	 *
+	 * Hashing runs a row at a time across the whole frame width, so it streams through memory
+	 * instead of hopping between tiles. Each 64-byte stripe of a tile row is folded into eight
+	 * 64-bit accumulators with multiply-accumulate against a key specific to its position in
+	 * the tile (the XXH3 long-input scheme), and the accumulators are finished off with
+	 * narwhal::Hash64 once the tile is complete. The row step uses AVX2 or SSE2 when the CPU
+	 * has them, picked once at construction, with a portable fallback otherwise; all three
+	 * produce the same hashes.
+	 *
+	 * Dirty tiles are merged into rectangles: runs of dirty tiles in a tile row become one
+	 * rectangle, which is grown downwards while the rows below have a run with the same span.
+	 */
+	struct TileDiff {
+		/**
+		 * Constructor.
+		 *
+		 * \param[in] tile_size Tile width and height in pixels.
+		 * 			Rounded up to a multiple of 16, and at most 64.
+		 */
+		explicit TileDiff(std::uint32_t tile_size = 32);
+
+		/**
+		 * Compare a frame against the previous one.
+		 *
+		 * The first frame, and any frame after a resize or Reset(), is entirely dirty.
+		 *
+		 * \return The merged dirty rectangles, valid until the next call.
+		 */
+		const std::vector<Rect>& Diff(const FramebufferView& frame);
+
+		/**
+		 * Forget the previous frame, so the next frame is entirely dirty
+		 * (e.g. when a new viewer needs a full update).
+		 */
+		void Reset();
+
+		[[nodiscard]] std::uint32_t GetTileSize() const;
+
+		/**
+		 * Get the number of tiles in the last frame diffed.
+		 */
+		[[nodiscard]] std::size_t TileCount() const;
+
+		/**
+		 * Get how many tiles were dirty in the last frame diffed.
+		 */
+		[[nodiscard]] std::size_t DirtyTileCount() const;
+
+		/**
+		 * Get the dirty flag of each tile of the last frame diffed, row major.
+		 */
+		[[nodiscard]] const std::vector<std::uint8_t>& DirtyTiles() const;
+
+		/**
+		 * Get the content hash of each tile of the last frame diffed, row major.
+		 * Hashes don't depend on where the tile is, so equal tiles anywhere have equal hashes.
+		 */
+		[[nodiscard]] const std::vector<std::uint64_t>& TileHashes() const;
+
+		/**
+		 * Get the rectangle covered by a tile of the last frame diffed.
+		 * Tiles on the right and bottom edges may be cut short.
+		 */
+		[[nodiscard]] Rect TileRect(std::size_t index) const;
+
+		/**
+		 * Merge a set of tiles of the last frame diffed into rectangles, the same way dirty tiles are.
+		 *
+		 * \param[in] tiles A flag per tile, row major (TileCount() of them).
+		 * \param[out] rects The rectangles. Cleared first.
+		 */
+		void MergeTiles(const std::vector<std::uint8_t>& tiles, std::vector<Rect>& rects) const;
+
+		/**
+		 * Get the name of the hashing kernel in use ("avx2", "sse2" or "scalar").
+		 */
+		[[nodiscard]] const char* KernelName() const;
+
+		/**
+		 * Accumulates one pixel row of a run of tiles.
+		 *
+		 * \param[in] row Start of the row data, tiles * stripes * 64 bytes.
+		 * \param[in] keys The keys for this row, stripes * 8.
+		 * \param[in] stripes 64-byte stripes per tile row.
+		 * \param[in] tiles Number of tiles.
+		 * \param[in,out] accumulators 8 per tile, 32-byte aligned.
+		 */
+		using RowKernel = void (*)(const std::uint8_t* row, const std::uint64_t* keys, std::size_t stripes, std::size_t tiles, std::uint64_t* accumulators);
+
+	   private:
+		void Resize(const FramebufferView& frame);
+
+		struct alignas(32) Accumulator {
+			std::uint64_t lanes[8];
+		};
+
+		std::uint32_t tile_size_;
+
+		RowKernel kernel_;
+		const char* kernel_name_;
+
+		/**
+		 * Per position keys: tile_size_ rows of stripes * 8.
+		 */
+		std::vector<std::uint64_t> keys_;
+
+		std::uint32_t width_ {};
+		std::uint32_t height_ {};
+		bool valid_ {};
+
+		std::uint32_t columns_ {};
+		std::uint32_t rows_ {};
+
+		/**
+		 * Content hash and dirty flag per tile, row major.
+		 */
+		std::vector<std::uint64_t> hashes_;
+		std::vector<std::uint8_t> tiles_;
+		std::size_t dirty_count_ {};
+
+		/**
+		 * Accumulators for the current tile row, one per tile column.
+		 */
+		std::vector<Accumulator> accumulators_;
+
+		/**
+		 * Zero padded copy of a row's partial last tile.
+		 */
+		std::vector<std::uint8_t> tail_;
+
+		std::vector<Rect> rects_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_TILEDIFF_H
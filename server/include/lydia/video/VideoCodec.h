@@ -0,0 +1,77 @@
+#ifndef LYDIA_VIDEO_VIDEOCODEC_H
+#define LYDIA_VIDEO_VIDEOCODEC_H
+
+#include <lydia/messages/DisplayMessages.h>
+#include <narwhal/PixelKernels.h>
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * An inter-frame video encoder, as used by VideoStream.
+	 *
+	 * Implementations keep the state of one stream of one size; a new size needs a new codec.
+	 * Like Encoder, a codec is not thread-safe, and is only used by the thread it encodes on.
+	 *
+	 * VP8 is built in when the server is built with libvpx. Other codecs can be plugged in
+	 * by handing VideoStream a different Factory.
+	 */
+	struct VideoCodec {
+		using Codec = messages::VideoFrameMessage::Codec;
+
+		struct Settings {
+			std::uint32_t width {};
+			std::uint32_t height {};
+
+			/**
+			 * Target bitrate, in kilobits per second.
+			 */
+			std::uint32_t bitrate { 2500 };
+
+			/**
+			 * Expected frame rate. Frames may come less often than this, but shouldn't come more often.
+			 */
+			std::uint32_t framerate { 30 };
+		};
+
+		/**
+		 * Makes a codec for a stream, or returns null if it can't.
+		 */
+		using Factory = std::function<std::unique_ptr<VideoCodec>(const Settings& settings)>;
+
+		/**
+		 * Make a codec with the best built-in implementation.
+		 *
+		 * \return The codec, or null if this build has none (or it failed to start).
+		 */
+		static std::unique_ptr<VideoCodec> Create(const Settings& settings);
+
+		/**
+		 * Get if this build has a built-in codec.
+		 */
+		static bool Available();
+
+		virtual ~VideoCodec() = default;
+
+		[[nodiscard]] virtual Codec GetCodec() const = 0;
+
+		/**
+		 * Encode a frame.
+		 *
+		 * \param[in] frame The frame, in I420, at the size the codec was made for.
+		 * \param[in] timestamp When the frame was captured, in milliseconds. Must go up.
+		 * \param[in] keyframe Make this a keyframe. The codec may also make one on its own.
+		 * \param[out] out The encoded frame. Empty if the codec dropped the frame (to keep to the bitrate).
+		 * \param[out] is_keyframe Set to whether out is a keyframe.
+		 * \return False if encoding failed, after which the codec shouldn't be used again.
+		 */
+		virtual bool Encode(const narwhal::I420Planes& frame, std::uint32_t timestamp, bool keyframe, std::vector<std::uint8_t>& out, bool& is_keyframe) = 0;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_VIDEOCODEC_H
@@ -0,0 +1,110 @@
+#ifndef LYDIA_VIDEO_VIDEOMODESWITCH_H
+#define LYDIA_VIDEO_VIDEOMODESWITCH_H
+
+#include <lydia/video/TileDiff.h>
+
+#include <chrono>
+#include <cstdint>
+
+namespace lydia::video {
+
+	/**
+	 * Decides when a VM's display should be sent as video rather than as rectangles.
+	 *
+	 * Tracks how much of the display changes per frame, smoothed over time. Once that stays
+	 * above a threshold for long enough (something is playing a video, or a game), it's
+	 * time for video mode; once it stays below a lower one for long enough, it's time to go
+	 * back. The gap between the two thresholds and the hold times keep a burst of activity,
+	 * or a short pause in a video, from flipping the mode back and forth.
+	 *
+	 * This is not thread-safe; it is expected to be owned by the thread that diffs the VM's frames.
+	 */
+	struct VideoModeSwitch {
+		using Clock = std::chrono::steady_clock;
+
+		/**
+		 * What to do with a frame.
+		 */
+		enum class Decision : std::uint8_t {
+			/**
+			 * Send the dirty rectangles, as usual.
+			 */
+			Rects,
+
+			/**
+			 * Video mode just ended. Send the whole frame as rectangles, replacing the lossy video.
+			 */
+			Refresh,
+
+			/**
+			 * Send the frame as video.
+			 */
+			Video
+		};
+
+		struct Settings {
+			/**
+			 * Smoothed fraction of tiles changing per frame to switch to video mode at...
+			 */
+			double enter_change { 0.15 };
+
+			/**
+			 * ...and to switch back below.
+			 */
+			double leave_change { 0.03 };
+
+			/**
+			 * How long the change rate must stay past a threshold before switching.
+			 */
+			std::chrono::milliseconds enter_after { 1000 };
+			std::chrono::milliseconds leave_after { 3000 };
+
+			/**
+			 * Time constant of the change rate's smoothing.
+			 */
+			std::chrono::milliseconds smoothing { 500 };
+		};
+
+		VideoModeSwitch();
+
+		explicit VideoModeSwitch(Settings settings);
+
+		/**
+		 * Account for a diffed frame, and decide what to do with it.
+		 * Should be called for every frame diffed, changed or not.
+		 *
+		 * \param[in] diff The TileDiff the frame was diffed with.
+		 */
+		Decision Update(const TileDiff& diff, Clock::time_point now = Clock::now());
+
+		/**
+		 * Leave video mode now (e.g. because the codec failed). The next Update() gives Refresh,
+		 * and video mode is only entered again after the change rate goes up again.
+		 */
+		void Leave();
+
+		[[nodiscard]] bool InVideoMode() const;
+
+		/**
+		 * Get the smoothed fraction of tiles changing per frame.
+		 */
+		[[nodiscard]] double GetChangeRate() const;
+
+	   private:
+		Settings settings_;
+
+		double rate_ {};
+		Clock::time_point last_update_ {};
+
+		/**
+		 * When the rate crossed the threshold for switching, or the epoch if it hasn't.
+		 */
+		Clock::time_point crossed_ {};
+
+		bool video_ {};
+		bool refresh_ {};
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_VIDEOMODESWITCH_H
@@ -0,0 +1,180 @@
+#ifndef LYDIA_VIDEO_VIDEOSTREAM_H
+#define LYDIA_VIDEO_VIDEOSTREAM_H
+
+#include <lydia/video/Framebuffer.h>
+#include <lydia/video/TileDiff.h>
+#include <lydia/video/VideoCodec.h>
+#include <lydia/video/VideoModeSwitch.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lydia::video {
+
+	/**
+	 * The video mode of one VM's display.
+	 *
+	 * Every diffed frame goes through Update(), which decides (with a VideoModeSwitch) whether
+	 * it's sent as rectangles or as video. Frames for video are encoded on the stream's own
+	 * thread, once for the VM, and each encoded frame is serialized into a VideoFrameMessage
+	 * and handed to the frame function as a shared buffer for every viewer to send as is.
+	 *
+	 * The encoder only ever has the newest frame waiting; if it falls behind, frames are
+	 * dropped rather than queued, so the video stays live.
+	 *
+	 * Update() is meant to be called by the thread that diffs the VM's frames.
+	 */
+	struct VideoStream {
+		using Clock = std::chrono::steady_clock;
+		using Buffer = std::shared_ptr<const std::vector<std::uint8_t>>;
+		using Decision = VideoModeSwitch::Decision;
+
+		/**
+		 * Function called on the stream's thread with each encoded frame (message header included).
+		 * Viewers that joined mid-stream should skip frames until the next keyframe.
+		 */
+		using FrameFunction = std::function<void(const Buffer& frame, bool keyframe)>;
+
+		struct Settings {
+			VideoModeSwitch::Settings mode {};
+
+			/**
+			 * Target bitrate, in kilobits per second.
+			 */
+			std::uint32_t bitrate { 2500 };
+
+			/**
+			 * Most frames encoded per second. Frames coming faster are skipped.
+			 */
+			std::uint32_t framerate { 30 };
+
+			/**
+			 * Time between keyframes, so a lost or skipped frame doesn't leave viewers stuck for long.
+			 */
+			std::chrono::milliseconds keyframe_interval { 10000 };
+
+			/**
+			 * Largest video size. Bigger frames are scaled down to fit, keeping their aspect ratio. 0 for no limit.
+			 */
+			std::uint32_t max_width {};
+			std::uint32_t max_height {};
+		};
+
+		/**
+		 * Constructor. Starts the encoding thread.
+		 *
+		 * \param[in] settings Settings.
+		 * \param[in] done Function called with encoded frames.
+		 * \param[in] factory Makes the codec; null for the built-in one. Video mode is never
+		 * 	   entered if there's no codec, and left for good if the codec fails.
+		 */
+		VideoStream(Settings settings, FrameFunction done, VideoCodec::Factory factory = nullptr);
+
+		VideoStream(const VideoStream&) = delete;
+		VideoStream& operator=(const VideoStream&) = delete;
+
+		/**
+		 * Stops and joins the encoding thread. A frame still waiting is dropped.
+		 */
+		~VideoStream();
+
+		/**
+		 * Account for a diffed frame, and decide what to do with it.
+		 * Should be called for every frame diffed, changed or not.
+		 *
+		 * \param[in] frame The frame that was diffed. Only kept if it's to be encoded.
+		 * \param[in] diff The TileDiff the frame was diffed with.
+		 * \return Video if the stream took the frame, and nothing else needs sending for it.
+		 */
+		Decision Update(const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now = Clock::now());
+
+		/**
+		 * Queue a frame for encoding, leaving the mode switch out of it,
+		 * for callers deciding the mode themselves (see Simulcast).
+		 *
+		 * \param[in] frame The frame.
+		 * \param[in] changed Whether the frame differs from the last one given.
+		 * \param[in] keyframe Make it a keyframe. Keyframes are never skipped.
+		 * \return True if the frame was queued, false if it was skipped (unchanged, or to keep to the frame rate).
+		 */
+		bool Submit(const std::shared_ptr<const Framebuffer>& frame, bool changed, bool keyframe, Clock::time_point now = Clock::now());
+
+		/**
+		 * Make the next encoded frame a keyframe, e.g. for a viewer who just joined.
+		 * Can be called from any thread.
+		 */
+		void RequestKeyframe();
+
+		[[nodiscard]] bool InVideoMode() const;
+
+		/**
+		 * Get if there's no codec, or it failed. Can be called from any thread.
+		 */
+		[[nodiscard]] bool Failed() const;
+
+		[[nodiscard]] const VideoModeSwitch& GetModeSwitch() const;
+
+	   private:
+		void ThreadEntry();
+
+		/**
+		 * Encode and deliver one frame. Returns false if the codec couldn't be made or failed.
+		 */
+		bool EncodeFrame(const Framebuffer& source, std::uint32_t timestamp, bool keyframe);
+
+		Settings settings_;
+		FrameFunction done_;
+		VideoCodec::Factory factory_;
+
+		// Only touched by Update() and Submit().
+
+		VideoModeSwitch switch_;
+		Clock::time_point epoch_;
+		Clock::time_point last_submit_ {};
+
+		/**
+		 * Whether a changed frame was skipped to keep to the frame rate, and the next has to go out even if unchanged.
+		 */
+		bool stale_ {};
+
+		// Shared with the encoding thread.
+
+		/**
+		 * Set when there's no codec, or it failed. Video mode isn't entered again.
+		 */
+		std::atomic<bool> failed_ {};
+		std::atomic<bool> keyframe_requested_ {};
+
+		std::mutex mutex_;
+		std::condition_variable cond_;
+		bool stopping_ {};
+
+		/**
+		 * Newest frame waiting to be encoded. Guarded by mutex_.
+		 */
+		std::shared_ptr<const Framebuffer> pending_;
+		std::uint32_t pending_timestamp_ {};
+		bool pending_keyframe_ {};
+
+		// The encoding thread's.
+
+		std::unique_ptr<VideoCodec> codec_;
+		VideoCodec::Settings codec_settings_ {};
+		Framebuffer scaled_;
+		std::vector<std::uint8_t> i420_;
+		std::vector<std::uint8_t> encoded_;
+		std::uint32_t last_keyframe_ {};
+
+		std::thread thread_;
+	};
+
+} // namespace lydia::video
+
+#endif //LYDIA_VIDEO_VIDEOSTREAM_H
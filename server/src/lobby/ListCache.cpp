@@ -0,0 +1,265 @@
+#include <lydia/lobby/ListCache.h>
+
+#include <algorithm>
+
+namespace lydia::lobby {
+
+	namespace {
+		using ChangeType = messages::ListChange::Type;
+
+		/**
+		 * Same layout as VMReference::Write(), without copying the preview into a ByteArray first.
+		 */
+		void WriteReference(binproto::BufferWriter& writer, const std::string& id, const binproto::Optional<messages::VMDescription>& description, const std::vector<std::uint8_t>* preview) {
+			writer.WriteString(id);
+			writer.WriteMessage(description);
+
+			const bool has_preview = preview && !preview->empty();
+			writer.WriteByte(has_preview);
+			if(has_preview)
+				writer.WriteBytes(*preview);
+		}
+
+		void Append(std::vector<std::uint8_t>& out, const std::vector<std::uint8_t>& bytes) {
+			out.insert(out.end(), bytes.begin(), bytes.end());
+		}
+
+	} // namespace
+
+	void ListCache::Set(const std::string& id, const binproto::Optional<messages::VMDescription>& description, std::shared_ptr<video::Thumbnail> thumbnail) {
+		auto* entry = Find(id);
+		const bool added = entry == nullptr;
+		if(added) {
+			entry = &entries_.emplace_back();
+			entry->id = id;
+		}
+
+		entry->description = description;
+		entry->thumbnail = std::move(thumbnail);
+		Serialize(*entry);
+		Record(added ? ChangeType::Added : ChangeType::DescriptionChanged, id);
+	}
+
+	void ListCache::Remove(const std::string& id) {
+		const auto it = std::find_if(entries_.begin(), entries_.end(), [&](const Entry& entry) {
+			return entry.id == id;
+		});
+
+		if(it == entries_.end())
+			return;
+
+		entries_.erase(it);
+		Record(ChangeType::Removed, id);
+	}
+
+	bool ListCache::Refresh() {
+		bool changed = false;
+
+		for(auto& entry : entries_) {
+			if(!entry.thumbnail || entry.thumbnail->GetVersion() == entry.preview_version)
+				continue;
+
+			Serialize(entry);
+			Record(ChangeType::PreviewChanged, entry.id);
+			changed = true;
+		}
+
+		return changed;
+	}
+
+	ListCache::Buffer ListCache::Get() {
+		Refresh();
+
+		if(response_)
+			return response_;
+
+		const messages::ListResponse empty;
+		binproto::BufferWriter writer(sizeof(std::uint32_t) * 2 + 1);
+		empty.header.Write(writer);
+		writer.WriteUint32(static_cast<std::uint32_t>(entries_.size()));
+
+		auto response = writer.Release();
+
+		std::size_t size = response.size();
+		for(const auto& entry : entries_)
+			size += entry.fragment->size();
+
+		response.reserve(size);
+		for(const auto& entry : entries_)
+			Append(response, *entry.fragment);
+
+		response_ = std::make_shared<const std::vector<std::uint8_t>>(std::move(response));
+		return response_;
+	}
+
+	ListCache::Buffer ListCache::GetUpdate(std::uint64_t since) {
+		Refresh();
+
+		if(since == version_)
+			return nullptr;
+
+		if(update_ && update_since_ == since)
+			return update_;
+
+		std::vector<std::uint8_t> changes;
+		std::uint32_t count = 0;
+
+		const bool reset = since == 0 || since > version_ || history_.Empty() || history_[0].version > since + 1;
+		if(reset) {
+			for(const auto& entry : entries_) {
+				changes.push_back(static_cast<std::uint8_t>(ChangeType::Added));
+				Append(changes, *entry.fragment);
+			}
+			count = static_cast<std::uint32_t>(entries_.size());
+		} else {
+			// Fold the missed changes into at most one add or removal, or one description
+			// and one preview change, per VM, in the order the VMs first changed.
+			struct Pending {
+				const std::string* id;
+				bool added;
+				bool description;
+				bool preview;
+			};
+
+			std::vector<Pending> pending;
+
+			for(std::size_t i = 0; i < history_.Size(); ++i) {
+				const auto& change = history_[i];
+				if(change.version <= since)
+					continue;
+
+				auto it = std::find_if(pending.begin(), pending.end(), [&](const Pending& p) {
+					return *p.id == change.id;
+				});
+				if(it == pending.end())
+					it = pending.insert(pending.end(), { &change.id, false, false, false });
+
+				switch(change.type) {
+					case ChangeType::Added:
+					case ChangeType::Removed:
+						*it = { it->id, change.type == ChangeType::Added, false, false };
+						break;
+					case ChangeType::DescriptionChanged:
+						it->description = true;
+						break;
+					case ChangeType::PreviewChanged:
+						it->preview = true;
+						break;
+				}
+			}
+
+			for(const auto& p : pending) {
+				const auto* entry = Find(*p.id);
+
+				if(!entry) {
+					SerializeChange(ChangeType::Removed, *p.id, nullptr, changes);
+					++count;
+					continue;
+				}
+
+				if(p.added) {
+					SerializeChange(ChangeType::Added, *p.id, entry, changes);
+					++count;
+					continue;
+				}
+
+				if(p.description) {
+					SerializeChange(ChangeType::DescriptionChanged, *p.id, entry, changes);
+					++count;
+				}
+
+				if(p.preview) {
+					SerializeChange(ChangeType::PreviewChanged, *p.id, entry, changes);
+					++count;
+				}
+			}
+		}
+
+		const messages::ListUpdateMessage empty;
+		binproto::BufferWriter writer(sizeof(std::uint64_t) * 3);
+		empty.header.Write(writer);
+		writer.WriteUint64(reset ? 0 : since);
+		writer.WriteUint64(version_);
+		writer.WriteUint32(count);
+
+		auto update = writer.Release();
+		update.reserve(update.size() + changes.size());
+		Append(update, changes);
+
+		update_ = std::make_shared<const std::vector<std::uint8_t>>(std::move(update));
+		update_since_ = since;
+		return update_;
+	}
+
+	ListCache::Buffer ListCache::GetReference(const std::string& id) const {
+		const auto* entry = Find(id);
+		if(!entry)
+			return nullptr;
+
+		return entry->fragment;
+	}
+
+	std::uint64_t ListCache::GetVersion() const {
+		return version_;
+	}
+
+	std::size_t ListCache::Size() const {
+		return entries_.size();
+	}
+
+	ListCache::Entry* ListCache::Find(const std::string& id) {
+		for(auto& entry : entries_)
+			if(entry.id == id)
+				return &entry;
+
+		return nullptr;
+	}
+
+	const ListCache::Entry* ListCache::Find(const std::string& id) const {
+		return const_cast<ListCache*>(this)->Find(id);
+	}
+
+	void ListCache::Serialize(Entry& entry) {
+		// Read the version first: if a new preview lands in between,
+		// the fragment has the new bytes under the old version, and is just redone next time.
+		video::Thumbnail::Bytes preview;
+		if(entry.thumbnail) {
+			entry.preview_version = entry.thumbnail->GetVersion();
+			preview = entry.thumbnail->Get();
+		}
+
+		binproto::BufferWriter writer(entry.id.size() + sizeof(messages::VMDescription) + (preview ? preview->size() : 0) + 16);
+		WriteReference(writer, entry.id, entry.description, preview.get());
+
+		entry.fragment = std::make_shared<const std::vector<std::uint8_t>>(writer.Release());
+	}
+
+	void ListCache::SerializeChange(ChangeType type, const std::string& id, const Entry* entry, std::vector<std::uint8_t>& out) {
+		out.push_back(static_cast<std::uint8_t>(type));
+
+		if(type == ChangeType::Added) {
+			Append(out, *entry->fragment);
+			return;
+		}
+
+		const binproto::Optional<messages::VMDescription> none;
+
+		// A preview newer than the recorded change is only better.
+		video::Thumbnail::Bytes preview;
+		if(type == ChangeType::PreviewChanged && entry->thumbnail)
+			preview = entry->thumbnail->Get();
+
+		binproto::BufferWriter writer(id.size() + sizeof(messages::VMDescription) + (preview ? preview->size() : 0) + 16);
+		WriteReference(writer, id, type == ChangeType::DescriptionChanged ? entry->description : none, preview.get());
+		Append(out, writer.Release());
+	}
+
+	void ListCache::Record(ChangeType type, const std::string& id) {
+		++version_;
+		history_.Push({ version_, type, id });
+
+		response_.reset();
+		update_.reset();
+	}
+
+} // namespace lydia::lobby
@@ -0,0 +1,45 @@
+#include <lydia/lobby/ListFeed.h>
+
+namespace lydia::lobby {
+
+	ListFeed::ListFeed(ListCache& cache, SendFunction send)
+		: cache_(cache),
+		  send_(std::move(send)) {
+	}
+
+	void ListFeed::Handle(std::uint64_t cid, const messages::ListSubscribeMessage& message) {
+		if(!message.subscribe) {
+			Remove(cid);
+			return;
+		}
+
+		if(auto update = cache_.GetUpdate(message.version))
+			send_(cid, update);
+
+		subscribers_[cid] = cache_.GetVersion();
+	}
+
+	void ListFeed::Remove(std::uint64_t cid) {
+		subscribers_.erase(cid);
+	}
+
+	void ListFeed::Tick() {
+		cache_.Refresh();
+
+		const auto version = cache_.GetVersion();
+		for(auto& [cid, known] : subscribers_) {
+			if(known == version)
+				continue;
+
+			// Subscribers are nearly always all at the same version, so the update the cache keeps serves them all.
+			if(auto update = cache_.GetUpdate(known))
+				send_(cid, update);
+			known = version;
+		}
+	}
+
+	std::size_t ListFeed::SubscriberCount() const {
+		return subscribers_.size();
+	}
+
+} // namespace lydia::lobby
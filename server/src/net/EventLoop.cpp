@@ -0,0 +1,116 @@
+#include <lydia/net/EventLoop.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+namespace lydia::net {
+
+	namespace {
+		constexpr int MaxEvents = 64;
+
+		[[noreturn]] void ThrowErrno(const char* what) {
+			throw std::system_error(errno, std::generic_category(), what);
+		}
+	} // namespace
+
+	EventLoop::EventLoop() {
+		epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+		if(epoll_fd_ == -1)
+			ThrowErrno("epoll_create1");
+
+		wake_fd_ = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+		if(wake_fd_ == -1) {
+			close(epoll_fd_);
+			ThrowErrno("eventfd");
+		}
+
+		Add(wake_fd_, EPOLLIN, [this](std::uint32_t) {
+			std::uint64_t value;
+			while(read(wake_fd_, &value, sizeof(value)) > 0)
+				;
+		});
+	}
+
+	EventLoop::~EventLoop() {
+		close(wake_fd_);
+		close(epoll_fd_);
+	}
+
+	void EventLoop::Add(int fd, std::uint32_t events, IoFunction function) {
+		epoll_event event {};
+		event.events = events;
+		event.data.fd = fd;
+
+		if(epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event) == -1)
+			ThrowErrno("epoll_ctl(EPOLL_CTL_ADD)");
+
+		functions_[fd] = std::make_shared<IoFunction>(std::move(function));
+	}
+
+	void EventLoop::Modify(int fd, std::uint32_t events) {
+		epoll_event event {};
+		event.events = events;
+		event.data.fd = fd;
+
+		if(epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event) == -1)
+			ThrowErrno("epoll_ctl(EPOLL_CTL_MOD)");
+	}
+
+	void EventLoop::Remove(int fd) {
+		// The fd may already be closed (which removes it from the epoll set),
+		// so failure here isn't an error.
+		epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+		functions_.erase(fd);
+	}
+
+	narwhal::TimerWheel& EventLoop::GetTimers() {
+		return timers_;
+	}
+
+	void EventLoop::RunOnce(int max_wait_ms) {
+		int timeout = max_wait_ms;
+
+		if(auto next = timers_.NextTimeout(); next.has_value()) {
+			// Round up, so we don't wake up just before the timer is due and spin.
+			auto ms = std::chrono::ceil<std::chrono::milliseconds>(*next).count();
+			if(timeout < 0 || ms < timeout)
+				timeout = static_cast<int>(ms);
+		}
+
+		epoll_event events[MaxEvents];
+		auto count = epoll_wait(epoll_fd_, &events[0], MaxEvents, timeout);
+		if(count == -1 && errno != EINTR)
+			ThrowErrno("epoll_wait");
+
+		for(int i = 0; i < count; ++i) {
+			auto it = functions_.find(events[i].data.fd);
+			if(it == functions_.end())
+				continue;
+
+			// Keep the function alive even if it removes itself.
+			auto function = it->second;
+			(*function)(events[i].events);
+		}
+
+		timers_.Advance();
+	}
+
+	void EventLoop::Run() {
+		should_run_.store(true);
+
+		while(should_run_.load())
+			RunOnce();
+	}
+
+	void EventLoop::Stop() {
+		should_run_.store(false);
+
+		std::uint64_t value = 1;
+		[[maybe_unused]] auto written = write(wake_fd_, &value, sizeof(value));
+	}
+
+} // namespace lydia::net
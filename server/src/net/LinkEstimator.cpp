@@ -0,0 +1,141 @@
+#include <lydia/net/LinkEstimator.h>
+
+#include <cmath>
+
+#ifdef __linux__
+	#include <netinet/in.h>
+	#include <netinet/tcp.h>
+	#include <sys/socket.h>
+#endif
+
+namespace lydia::net {
+
+	namespace {
+		/**
+		 * Weight of a new throughput sample.
+		 */
+		constexpr double ThroughputGain = 0.25;
+
+		/**
+		 * RFC 6298 gains for the round trip time and its variance.
+		 */
+		constexpr double RttGain = 0.125;
+		constexpr double RttVarianceGain = 0.25;
+	} // namespace
+
+	void LinkEstimator::OnWrite(std::size_t written, std::size_t remaining, Clock::time_point now) {
+		if(backed_up_ != Clock::time_point {})
+			backed_up_bytes_ += written;
+
+		if(remaining == 0) {
+			Sample(now);
+			backed_up_ = {};
+			return;
+		}
+
+		if(backed_up_ == Clock::time_point {}) {
+			backed_up_ = now;
+			backed_up_bytes_ = 0;
+			return;
+		}
+
+		if(now - backed_up_ >= MaxSample) {
+			Sample(now);
+			backed_up_ = now;
+			backed_up_bytes_ = 0;
+		}
+	}
+
+	bool LinkEstimator::Poll(int fd, Clock::time_point now) {
+#ifdef __linux__
+		tcp_info info {};
+		socklen_t length = sizeof(info);
+		if(getsockopt(fd, IPPROTO_TCP, TCP_INFO, &info, &length) != 0)
+			return false;
+
+		if(info.tcpi_rtt == 0)
+			return true;
+
+		OnRtt(std::chrono::microseconds(info.tcpi_rtt));
+
+		// Only while the send queue isn't telling us anything better.
+		if(last_sample_ == Clock::time_point {} || now - last_sample_ >= DrainTimeout) {
+			const auto window = static_cast<double>(info.tcpi_snd_cwnd) * info.tcpi_snd_mss;
+			if(window > 0.0)
+				OnThroughput(window * 1e6 / info.tcpi_rtt);
+		}
+
+		return true;
+#else
+		static_cast<void>(fd);
+		static_cast<void>(now);
+		return false;
+#endif
+	}
+
+	messages::PingMessage LinkEstimator::MakePing(Clock::time_point now) {
+		ping_nonce_ = random_();
+		ping_sent_ = now;
+		ping_pending_ = true;
+
+		messages::PingMessage message;
+		message.nonce = ping_nonce_;
+		return message;
+	}
+
+	void LinkEstimator::OnPing(const messages::PingMessage& message, Clock::time_point now) {
+		if(!ping_pending_ || message.nonce != ping_nonce_ || now < ping_sent_)
+			return;
+
+		ping_pending_ = false;
+		OnRtt(std::chrono::duration_cast<std::chrono::microseconds>(now - ping_sent_));
+	}
+
+	void LinkEstimator::OnRtt(std::chrono::microseconds rtt) {
+		const auto sample = static_cast<double>(rtt.count());
+
+		if(!has_rtt_) {
+			has_rtt_ = true;
+			srtt_ = sample;
+			rttvar_ = sample / 2;
+		} else {
+			rttvar_ += (std::abs(srtt_ - sample) - rttvar_) * RttVarianceGain;
+			srtt_ += (sample - srtt_) * RttGain;
+		}
+
+		rtt_.store(static_cast<std::int64_t>(srtt_), std::memory_order_relaxed);
+		rtt_variance_.store(static_cast<std::int64_t>(rttvar_), std::memory_order_relaxed);
+	}
+
+	double LinkEstimator::GetThroughput() const {
+		return throughput_.load(std::memory_order_relaxed);
+	}
+
+	std::chrono::microseconds LinkEstimator::GetRtt() const {
+		return std::chrono::microseconds(rtt_.load(std::memory_order_relaxed));
+	}
+
+	std::chrono::microseconds LinkEstimator::GetRttVariance() const {
+		return std::chrono::microseconds(rtt_variance_.load(std::memory_order_relaxed));
+	}
+
+	void LinkEstimator::OnThroughput(double bytes_per_second) {
+		// Only the event thread writes, so a plain load and store is enough.
+		const auto current = throughput_.load(std::memory_order_relaxed);
+		const auto smoothed = current == 0.0 ? bytes_per_second : current + (bytes_per_second - current) * ThroughputGain;
+		throughput_.store(smoothed, std::memory_order_relaxed);
+	}
+
+	void LinkEstimator::Sample(Clock::time_point now) {
+		if(backed_up_ == Clock::time_point {} || backed_up_bytes_ == 0)
+			return;
+
+		const auto elapsed = now - backed_up_;
+		if(elapsed < MinSample)
+			return;
+
+		OnThroughput(static_cast<double>(backed_up_bytes_) / std::chrono::duration<double>(elapsed).count());
+		last_sample_ = now;
+	}
+
+} // namespace lydia::net
@@ -0,0 +1,174 @@
+#include <lydia/net/SendQueue.h>
+
+#include <algorithm>
+
+namespace lydia::net {
+
+	SendQueue::SendQueue()
+		: SendQueue(Settings {}) {
+	}
+
+	SendQueue::SendQueue(Settings settings)
+		: settings_(settings) {
+	}
+
+	SendQueue::Result SendQueue::Push(Buffer buffer, Policy policy, std::uint64_t key, bool sync) {
+		if(overflowed_)
+			return Result::Overflow;
+
+		const auto size = buffer->size();
+
+		if(policy == Policy::Stream) {
+			if(sync) {
+				// Everything of the stream still queued is made obsolete by it, except for
+				// a message that's partly written already, which has to be finished.
+				for(std::size_t i = 0; i < entries_.size(); ++i) {
+					auto& entry = entries_[i];
+					if(!entry.buffer || entry.policy != Policy::Stream || entry.key != key)
+						continue;
+					if(i == 0 && offset_ != 0)
+						continue;
+					Remove(entry);
+				}
+				Trim();
+				dropping_.erase(key);
+
+				// The soft limit isn't checked: dropping a sync message would only make
+				// the stream ask for another, and a refresh may well be bigger than the
+				// limit on its own. Only the hard limit, below, stops it.
+			} else if(dropping_.contains(key)) {
+				return Result::Dropped;
+			} else if(bytes_ + size > settings_.soft_limit) {
+				dropping_.insert(key);
+				return Result::Dropped;
+			}
+		}
+
+		if(policy == Policy::Supersede) {
+			if(const auto it = latest_.find(key); it != latest_.end()) {
+				const auto index = IndexOf(it->second);
+				auto& entry = entries_[index];
+
+				// A partly written message can't be swapped out; the new one goes behind it.
+				if(index != 0 || offset_ == 0) {
+					if(bytes_ - entry.buffer->size() + size > settings_.hard_limit) {
+						overflowed_ = true;
+						return Result::Overflow;
+					}
+
+					bytes_ = bytes_ - entry.buffer->size() + size;
+					entry.buffer = std::move(buffer);
+					return Result::Replaced;
+				}
+			}
+		}
+
+		if(bytes_ + size > settings_.hard_limit) {
+			overflowed_ = true;
+			return Result::Overflow;
+		}
+
+		if(policy == Policy::Supersede)
+			latest_[key] = front_sequence_ + entries_.size();
+
+		entries_.push_back(Entry { std::move(buffer), policy, key });
+		bytes_ += size;
+		++size_;
+		return Result::Queued;
+	}
+
+	std::span<const std::uint8_t> SendQueue::Front() const {
+		if(entries_.empty())
+			return {};
+
+		const auto& buffer = *entries_.front().buffer;
+		return std::span<const std::uint8_t>(buffer).subspan(offset_);
+	}
+
+	void SendQueue::Consume(std::size_t bytes) {
+		while(bytes != 0 && !entries_.empty()) {
+			auto& entry = entries_.front();
+			const auto left = entry.buffer->size() - offset_;
+
+			if(bytes < left) {
+				offset_ += bytes;
+				bytes_ -= bytes;
+				return;
+			}
+
+			bytes -= left;
+			bytes_ -= left;
+			offset_ = 0;
+
+			if(entry.policy == Policy::Supersede) {
+				const auto it = latest_.find(entry.key);
+				if(it != latest_.end() && it->second == front_sequence_)
+					latest_.erase(it);
+			}
+
+			entries_.pop_front();
+			++front_sequence_;
+			--size_;
+			Trim();
+		}
+	}
+
+	SendQueue::Slice SendQueue::Take(std::size_t max) {
+		if(entries_.empty())
+			return {};
+
+		const auto& entry = entries_.front();
+		Slice slice { entry.buffer, offset_, std::min(max, entry.buffer->size() - offset_) };
+		Consume(slice.size);
+		return slice;
+	}
+
+	bool SendQueue::Empty() const {
+		return entries_.empty();
+	}
+
+	std::size_t SendQueue::Bytes() const {
+		return bytes_;
+	}
+
+	std::size_t SendQueue::Size() const {
+		return size_;
+	}
+
+	bool SendQueue::NeedsSync(std::uint64_t key) const {
+		return dropping_.contains(key);
+	}
+
+	bool SendQueue::Overflowed() const {
+		return overflowed_;
+	}
+
+	void SendQueue::Clear() {
+		front_sequence_ += entries_.size();
+		entries_.clear();
+		offset_ = 0;
+		bytes_ = 0;
+		size_ = 0;
+		latest_.clear();
+		dropping_.clear();
+		overflowed_ = false;
+	}
+
+	std::size_t SendQueue::IndexOf(std::uint64_t sequence) const {
+		return static_cast<std::size_t>(sequence - front_sequence_);
+	}
+
+	void SendQueue::Remove(Entry& entry) {
+		bytes_ -= entry.buffer->size();
+		--size_;
+		entry.buffer.reset();
+	}
+
+	void SendQueue::Trim() {
+		while(!entries_.empty() && !entries_.front().buffer) {
+			entries_.pop_front();
+			++front_sequence_;
+		}
+	}
+
+} // namespace lydia::net
@@ -0,0 +1,182 @@
+#include <lydia/messages/ConnectMessage.h>
+#include <lydia/net/SendScheduler.h>
+
+#include <algorithm>
+
+namespace lydia::net {
+
+	SendScheduler::SendScheduler()
+		: SendScheduler(Settings {}) {
+	}
+
+	SendScheduler::SendScheduler(Settings settings)
+		: settings_(settings) {
+		for(auto& lane : lanes_)
+			lane = SendQueue(settings_.queue);
+	}
+
+	SendScheduler::Lane SendScheduler::LaneOf(messages::MessageOpcode opcode) {
+		using Opcode = messages::MessageOpcode;
+
+		switch(opcode) {
+			case Opcode::Connect:
+			case Opcode::Key:
+			case Opcode::Mouse:
+			case Opcode::MouseMovement:
+			case Opcode::MouseCursorUpdate:
+			case Opcode::Turn:
+			case Opcode::TurnAdministration:
+			case Opcode::TurnUpdate:
+			case Opcode::Ping:
+				return Lane::Urgent;
+
+			case Opcode::UserConnects:
+			case Opcode::UserDisconnect:
+			case Opcode::UserRename:
+			case Opcode::ChatCreateWhisperChannel:
+			case Opcode::ChatDeleteWhisperChannel:
+			case Opcode::ChatMessage:
+			case Opcode::ListSubscribe:
+			case Opcode::ListUpdate:
+				return Lane::Interactive;
+
+			default:
+				return Lane::Bulk;
+		}
+	}
+
+	SendQueue::Result SendScheduler::Push(Lane lane, Buffer buffer, SendQueue::Policy policy, std::uint64_t key, bool sync) {
+		return lanes_[static_cast<std::size_t>(lane)].Push(std::move(buffer), policy, key, sync);
+	}
+
+	std::span<const std::uint8_t> SendScheduler::Front() {
+		if(batch_.empty() && !Take())
+			return {};
+
+		const auto& piece = batch_.front();
+		return std::span<const std::uint8_t>(*piece.buffer).subspan(piece.offset, piece.size);
+	}
+
+	std::size_t SendScheduler::Gather(std::span<iovec> out, std::size_t max_bytes) {
+		// A piece may come with a chunk header, so take one only while there's room for both.
+		while(batch_bytes_ < max_bytes && batch_.size() + 2 <= out.size() && Take())
+			;
+
+		std::size_t count = 0;
+		for(const auto& piece : batch_) {
+			if(count == out.size())
+				break;
+
+			// iovec isn't const-correct; writev()/sendmsg() only read through it.
+			out[count].iov_base = const_cast<std::uint8_t*>(piece.buffer->data() + piece.offset);
+			out[count].iov_len = piece.size;
+			++count;
+		}
+
+		return count;
+	}
+
+	void SendScheduler::Consume(std::size_t bytes) {
+		while(bytes != 0 && !batch_.empty()) {
+			auto& piece = batch_.front();
+			const auto count = std::min(bytes, piece.size);
+
+			piece.offset += count;
+			piece.size -= count;
+			batch_bytes_ -= count;
+			bytes -= count;
+
+			if(piece.size == 0)
+				batch_.pop_front();
+		}
+	}
+
+	bool SendScheduler::Empty() const {
+		return batch_.empty() && std::all_of(lanes_.begin(), lanes_.end(), [](const SendQueue& lane) { return lane.Empty(); });
+	}
+
+	std::size_t SendScheduler::Bytes() const {
+		std::size_t bytes = batch_bytes_;
+		for(const auto& lane : lanes_)
+			bytes += lane.Bytes();
+		return bytes;
+	}
+
+	bool SendScheduler::Overflowed() const {
+		return std::any_of(lanes_.begin(), lanes_.end(), [](const SendQueue& lane) { return lane.Overflowed(); });
+	}
+
+	const SendQueue& SendScheduler::GetQueue(Lane lane) const {
+		return lanes_[static_cast<std::size_t>(lane)];
+	}
+
+	void SendScheduler::Clear() {
+		for(auto& lane : lanes_)
+			lane.Clear();
+		starved_ = {};
+		chunking_ = {};
+		batch_.clear();
+		batch_bytes_ = 0;
+	}
+
+	bool SendScheduler::Take() {
+		auto lane = None;
+
+		for(std::size_t i = 0; i < LaneCount; ++i) {
+			if(lanes_[i].Empty()) {
+				starved_[i] = 0;
+				continue;
+			}
+
+			if(lane == None)
+				lane = i;
+			else if(starved_[i] >= settings_.fair_share) {
+				lane = i;
+				break;
+			}
+		}
+
+		if(lane == None)
+			return false;
+
+		auto& queue = lanes_[lane];
+		auto& chunking = chunking_[lane];
+		const auto left = queue.Front().size();
+		if(!chunking && left > settings_.chunk_size)
+			chunking = true;
+
+		auto size = left;
+
+		if(chunking) {
+			size = std::min(left, settings_.chunk_size);
+			const bool last = size == left;
+
+			// The data itself goes from the queued buffer, not copied into the ChunkMessage.
+			// Each lane is a stream of its own, since lanes take turns in the middle of messages.
+			binproto::BufferWriter writer(16);
+			messages::ChunkMessage::WriteHeader(writer, static_cast<std::uint8_t>(lane), last, static_cast<std::uint32_t>(size));
+			auto header = std::make_shared<const std::vector<std::uint8_t>>(writer.Release());
+
+			size += header->size();
+			batch_bytes_ += header->size();
+			batch_.push_back(SendQueue::Slice { header, 0, header->size() });
+
+			if(last)
+				chunking = false;
+		}
+
+		auto data = queue.Take(settings_.chunk_size);
+		batch_bytes_ += data.size;
+		batch_.push_back(std::move(data));
+
+		// Everything less urgent that's waiting has waited for this.
+		for(std::size_t i = lane + 1; i < LaneCount; ++i) {
+			if(!lanes_[i].Empty())
+				starved_[i] += size;
+		}
+		starved_[lane] = 0;
+
+		return true;
+	}
+
+} // namespace lydia::net
@@ -0,0 +1,116 @@
+#include <lydia/net/SocketWriter.h>
+
+#include <algorithm>
+#include <cerrno>
+
+#include <sys/socket.h>
+
+namespace lydia::net {
+
+	namespace {
+		// Not every platform has these; without them each sendmsg() is simply pushed out.
+#ifdef MSG_MORE
+		constexpr int MoreFlag = MSG_MORE;
+#else
+		constexpr int MoreFlag = 0;
+#endif
+
+#ifdef MSG_NOSIGNAL
+		constexpr int NoSignalFlag = MSG_NOSIGNAL;
+#else
+		constexpr int NoSignalFlag = 0;
+#endif
+	} // namespace
+
+	SocketWriter::SocketWriter(int fd)
+		: SocketWriter(fd, Settings {}) {
+	}
+
+	SocketWriter::SocketWriter(int fd, Settings settings)
+		: fd_(fd),
+		  settings_(settings),
+		  scheduler_(settings_.scheduler) {
+		// A piece may need a chunk header ahead of it; with room for less, nothing could be gathered.
+		settings_.max_pieces = std::max<std::size_t>(settings_.max_pieces, 2);
+		pieces_.resize(settings_.max_pieces);
+	}
+
+	SendQueue::Result SocketWriter::Push(SendScheduler::Lane lane, SendQueue::Buffer buffer, SendQueue::Policy policy, std::uint64_t key, bool sync) {
+		const auto result = scheduler_.Push(lane, std::move(buffer), policy, key, sync);
+		if(result == SendQueue::Result::Overflow)
+			closed_ = true;
+		return result;
+	}
+
+	SocketWriter::Status SocketWriter::Send(SendScheduler::Lane lane, SendQueue::Buffer buffer, SendQueue::Policy policy, std::uint64_t key, bool sync) {
+		Push(lane, std::move(buffer), policy, key, sync);
+		if(closed_)
+			return Status::Closed;
+
+		// No use trying; it goes as soon as the socket is writable.
+		if(blocked_)
+			return Status::Blocked;
+
+		return Flush();
+	}
+
+	SocketWriter::Status SocketWriter::Flush(Clock::time_point now) {
+		if(closed_)
+			return Status::Closed;
+
+		for(;;) {
+			const auto count = scheduler_.Gather(pieces_, settings_.max_batch);
+			if(count == 0) {
+				blocked_ = false;
+				return Status::Done;
+			}
+
+			std::size_t size = 0;
+			for(std::size_t i = 0; i < count; ++i)
+				size += pieces_[i].iov_len;
+
+			msghdr message {};
+			message.msg_iov = pieces_.data();
+			message.msg_iovlen = count;
+
+			// Keep the socket corked while there's more to come after this batch.
+			const auto flags = MSG_DONTWAIT | NoSignalFlag | (scheduler_.Bytes() > size ? MoreFlag : 0);
+
+			const auto written = sendmsg(fd_, &message, flags);
+			if(written < 0) {
+				if(errno == EINTR)
+					continue;
+
+				if(errno == EAGAIN || errno == EWOULDBLOCK) {
+					blocked_ = true;
+					estimator_.OnWrite(0, scheduler_.Bytes(), now);
+					return Status::Blocked;
+				}
+
+				closed_ = true;
+				return Status::Closed;
+			}
+
+			scheduler_.Consume(static_cast<std::size_t>(written));
+			estimator_.OnWrite(static_cast<std::size_t>(written), scheduler_.Bytes(), now);
+
+			if(static_cast<std::size_t>(written) < size) {
+				blocked_ = true;
+				return Status::Blocked;
+			}
+		}
+	}
+
+	bool SocketWriter::Blocked() const {
+		return blocked_;
+	}
+
+	SendScheduler& SocketWriter::GetScheduler() {
+		return scheduler_;
+	}
+
+	LinkEstimator& SocketWriter::GetEstimator() {
+		return estimator_;
+	}
+
+} // namespace lydia::net
@@ -0,0 +1,240 @@
+#include <lydia/room/ChatService.h>
+
+#include <algorithm>
+
+namespace lydia::room {
+
+	ChatService::Channel::Channel(std::size_t history_length)
+		: history(history_length) {
+	}
+
+	ChatService::ChatService(BroadcastFunction broadcast, SendFunction send, WhisperCreatedFunction whisper_created, WhisperDeletedFunction whisper_deleted)
+		: broadcast_(std::move(broadcast)),
+		  send_(std::move(send)),
+		  whisper_created_(std::move(whisper_created)),
+		  whisper_deleted_(std::move(whisper_deleted)) {
+	}
+
+	bool ChatService::Post(std::uint64_t uid, const messages::ChatClientMessage& message, Clock::time_point now) {
+		const auto& text = message.message.Get();
+		if(text.empty() || text.size() > MaxMessageLength)
+			return false;
+
+		switch(message.channel.type) {
+			case messages::ChatChannelReference::Type::VMChat:
+				Push(room_, uid, text, now);
+				return true;
+
+			case messages::ChatChannelReference::Type::Whisper: {
+				auto* channel = FindWhisper(uid, message.channel);
+				if(!channel)
+					return false;
+
+				if(channel->pending == 0)
+					dirty_.push_back(static_cast<std::uint32_t>(message.channel.id & 0xFFFFFFFF));
+				Push(*channel, uid, text, now);
+				return true;
+			}
+
+			default:
+				return false;
+		}
+	}
+
+	std::optional<messages::ChatChannelReference> ChatService::CreateWhisper(std::uint64_t uid, std::uint64_t peer) {
+		if(uid == peer)
+			return std::nullopt;
+
+		auto& own = user_whispers_[uid];
+
+		// Already whispering with them?
+		for(auto index : own) {
+			const auto& channel = whispers_[index];
+			if(channel.members[0] == peer || channel.members[1] == peer) {
+				const auto reference = MakeWhisperReference(index, channel.generation);
+
+				if(whisper_created_) {
+					messages::ChatCreateWhisperChannelServerMessage message;
+					message.channel = reference;
+					message.user.uid = peer;
+					whisper_created_(uid, message);
+				}
+
+				return reference;
+			}
+		}
+
+		auto& theirs = user_whispers_[peer];
+		if(own.size() >= MaxWhispersPerUser || theirs.size() >= MaxWhispersPerUser)
+			return std::nullopt;
+
+		std::uint32_t index;
+		if(!free_.empty()) {
+			index = free_.back();
+			free_.pop_back();
+		} else {
+			index = static_cast<std::uint32_t>(whispers_.size());
+			whispers_.emplace_back(WhisperHistoryLength);
+		}
+
+		auto& channel = whispers_[index];
+		channel.used = true;
+		channel.pending = 0;
+		channel.history.Clear();
+		channel.members[0] = uid;
+		channel.members[1] = peer;
+
+		own.push_back(index);
+		theirs.push_back(index);
+
+		const auto reference = MakeWhisperReference(index, channel.generation);
+
+		if(whisper_created_) {
+			messages::ChatCreateWhisperChannelServerMessage message;
+			message.channel = reference;
+
+			message.user.uid = peer;
+			whisper_created_(uid, message);
+
+			message.user.uid = uid;
+			whisper_created_(peer, message);
+		}
+
+		return reference;
+	}
+
+	bool ChatService::DeleteWhisper(std::uint64_t uid, const messages::ChatChannelReference& channel) {
+		if(!FindWhisper(uid, channel))
+			return false;
+
+		CloseWhisper(static_cast<std::uint32_t>(channel.id & 0xFFFFFFFF));
+		return true;
+	}
+
+	void ChatService::RemoveUser(std::uint64_t uid) {
+		auto it = user_whispers_.find(uid);
+		if(it == user_whispers_.end())
+			return;
+
+		// CloseWhisper() edits this list, so work off a copy.
+		const auto indices = it->second;
+		for(auto index : indices)
+			CloseWhisper(index);
+
+		user_whispers_.erase(uid);
+	}
+
+	void ChatService::Tick() {
+		if(room_.pending != 0) {
+			if(broadcast_)
+				broadcast_(MakeMessage(room_, {}, room_.pending));
+			room_.pending = 0;
+		}
+
+		for(auto index : dirty_) {
+			auto& channel = whispers_[index];
+
+			// Stale entry for a channel closed (and maybe reopened) since it was marked.
+			if(!channel.used || channel.pending == 0)
+				continue;
+
+			if(send_) {
+				const auto message = MakeMessage(channel, MakeWhisperReference(index, channel.generation), channel.pending);
+				send_(channel.members[0], message);
+				send_(channel.members[1], message);
+			}
+
+			channel.pending = 0;
+		}
+
+		dirty_.clear();
+	}
+
+	messages::ChatServerMessage ChatService::MakeHistory() const {
+		return MakeMessage(room_, {}, room_.history.Size());
+	}
+
+	std::size_t ChatService::WhisperCount() const {
+		return whispers_.size() - free_.size();
+	}
+
+	ChatService::Channel* ChatService::FindWhisper(std::uint64_t uid, const messages::ChatChannelReference& channel) {
+		if(channel.type != messages::ChatChannelReference::Type::Whisper)
+			return nullptr;
+
+		const auto index = static_cast<std::uint32_t>(channel.id & 0xFFFFFFFF);
+		const auto generation = static_cast<std::uint32_t>(channel.id >> 32);
+		if(index >= whispers_.size())
+			return nullptr;
+
+		auto& whisper = whispers_[index];
+		if(!whisper.used || whisper.generation != generation)
+			return nullptr;
+
+		if(whisper.members[0] != uid && whisper.members[1] != uid)
+			return nullptr;
+
+		return &whisper;
+	}
+
+	void ChatService::CloseWhisper(std::uint32_t index) {
+		auto& channel = whispers_[index];
+		if(!channel.used)
+			return;
+
+		if(whisper_deleted_) {
+			messages::ChatDeleteWhisperChannelMessage message;
+			message.channel = MakeWhisperReference(index, channel.generation);
+			whisper_deleted_(channel.members[0], message);
+			whisper_deleted_(channel.members[1], message);
+		}
+
+		for(auto uid : channel.members) {
+			if(auto it = user_whispers_.find(uid); it != user_whispers_.end()) {
+				auto& indices = it->second;
+				indices.erase(std::remove(indices.begin(), indices.end(), index), indices.end());
+			}
+		}
+
+		// The history is cleared when the slot is reused, which keeps its storage around.
+		channel.used = false;
+		channel.pending = 0;
+		++channel.generation;
+		free_.push_back(index);
+	}
+
+	messages::ChatChannelReference ChatService::MakeWhisperReference(std::uint32_t index, std::uint32_t generation) {
+		messages::ChatChannelReference reference;
+		reference.id = (static_cast<std::uint64_t>(generation) << 32) | index;
+		reference.type = messages::ChatChannelReference::Type::Whisper;
+		return reference;
+	}
+
+	messages::ChatServerMessage ChatService::MakeMessage(const Channel& channel, const messages::ChatChannelReference& reference, std::size_t count) {
+		messages::ChatServerMessage message;
+		message.channel = reference;
+
+		auto& lines = message.lines.GetUnderlying();
+		lines.resize(count);
+
+		const auto first = channel.history.Size() - count;
+		for(std::size_t i = 0; i < count; ++i) {
+			const auto& line = channel.history[first + i];
+			lines[i].user.uid = line.uid;
+			lines[i].message = line.message;
+			lines[i].timestamp = line.timestamp;
+		}
+
+		return message;
+	}
+
+	void ChatService::Push(Channel& channel, std::uint64_t uid, const std::string& message, Clock::time_point now) {
+		auto& line = channel.history.NextSlot();
+		line.uid = uid;
+		line.message.assign(message);
+		line.timestamp = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count());
+
+		channel.pending = std::min(channel.pending + 1, channel.history.Size());
+	}
+
+} // namespace lydia::room
@@ -0,0 +1,55 @@
+#include <lydia/room/JoinPacer.h>
+
+#include <algorithm>
+
+namespace lydia::room {
+
+	JoinPacer::JoinPacer()
+		: JoinPacer(Settings {}) {
+	}
+
+	JoinPacer::JoinPacer(Settings settings)
+		: settings_(settings),
+		  tokens_(static_cast<double>(settings.burst)) {
+	}
+
+	void JoinPacer::Request(std::uint64_t cid) {
+		if(!waiting_.insert(cid).second)
+			return;
+
+		queue_.push_back(cid);
+	}
+
+	void JoinPacer::Cancel(std::uint64_t cid) {
+		waiting_.erase(cid);
+	}
+
+	const std::vector<std::uint64_t>& JoinPacer::Admit(Clock::time_point now) {
+		admitted_.clear();
+
+		if(last_ != Clock::time_point {})
+			tokens_ += std::chrono::duration<double>(now - last_).count() * settings_.rate;
+		tokens_ = std::min(tokens_, static_cast<double>(settings_.burst));
+		last_ = now;
+
+		while(!queue_.empty() && tokens_ >= 1.0) {
+			const auto cid = queue_.front();
+			queue_.pop_front();
+
+			// Cancelled. One cancelled and requested again keeps its old place, and is skipped further back.
+			if(!waiting_.contains(cid))
+				continue;
+
+			waiting_.erase(cid);
+			admitted_.push_back(cid);
+			tokens_ -= 1.0;
+		}
+
+		return admitted_;
+	}
+
+	std::size_t JoinPacer::Waiting() const {
+		return waiting_.size();
+	}
+
+} // namespace lydia::room
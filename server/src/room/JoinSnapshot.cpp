@@ -0,0 +1,115 @@
+#include <lydia/room/JoinSnapshot.h>
+
+namespace lydia::room {
+
+	namespace {
+		template <class Message>
+		JoinSnapshot::Buffer Serialize(const Message& message) {
+			binproto::BufferWriter writer(256);
+			message.header.Write(writer);
+			message.WritePayload(writer);
+			return std::make_shared<const std::vector<std::uint8_t>>(writer.Release());
+		}
+
+		/**
+		 * Serialized size of a user reference: uid, username presence, length and the username.
+		 */
+		std::size_t SizeOf(const messages::UserReference& ref) {
+			std::size_t size = sizeof(std::uint64_t) + sizeof(std::uint8_t);
+			if(ref.username.HasValue())
+				size += sizeof(std::uint32_t) + ref.username.Value().Get().size();
+			return size;
+		}
+
+		/**
+		 * Split the users into messages of about max_size bytes each, and serialize those.
+		 */
+		std::vector<JoinSnapshot::Buffer> SerializeUsers(messages::AddUsersMessage&& all, std::size_t max_size) {
+			// Header, and the array's length.
+			constexpr std::size_t Overhead = sizeof(std::uint32_t) + sizeof(std::uint8_t) + sizeof(std::uint32_t);
+
+			std::vector<JoinSnapshot::Buffer> buffers;
+			messages::AddUsersMessage message;
+			auto& users = message.users.GetUnderlying();
+			std::size_t size = Overhead;
+
+			for(auto& ref : all.users.GetUnderlying()) {
+				const auto ref_size = SizeOf(ref);
+				if(!users.empty() && size + ref_size > max_size) {
+					buffers.push_back(Serialize(message));
+					users.clear();
+					size = Overhead;
+				}
+
+				users.push_back(std::move(ref));
+				size += ref_size;
+			}
+
+			if(!users.empty())
+				buffers.push_back(Serialize(message));
+
+			return buffers;
+		}
+	} // namespace
+
+	JoinSnapshot::JoinSnapshot(const NameTable& names, const TurnQueue& turns, BuildFunction cursor, BuildFunction display)
+		: JoinSnapshot(names, turns, std::move(cursor), std::move(display), Settings {}) {
+	}
+
+	JoinSnapshot::JoinSnapshot(const NameTable& names, const TurnQueue& turns, BuildFunction cursor, BuildFunction display, Settings settings)
+		: names_(names),
+		  turns_(turns),
+		  build_cursor_(std::move(cursor)),
+		  build_display_(std::move(display)),
+		  settings_(settings) {
+	}
+
+	void JoinSnapshot::InvalidateCursor() {
+		cursor_stale_ = true;
+	}
+
+	void JoinSnapshot::InvalidateDisplay() {
+		display_stale_ = true;
+	}
+
+	std::shared_ptr<const JoinSnapshot::Snapshot> JoinSnapshot::Get(Clock::time_point now) {
+		const bool users_stale = !snapshot_ || names_.GetVersion() != names_version_;
+		const bool turn_stale = users_stale || turns_.GetVersion() != turns_version_ || now - turn_built_ >= settings_.turn_max_age;
+
+		if(!users_stale && !turn_stale && !cursor_stale_ && !display_stale_)
+			return snapshot_;
+
+		auto snapshot = snapshot_ ? std::make_shared<Snapshot>(*snapshot_) : std::make_shared<Snapshot>();
+		++snapshot->version;
+
+		if(users_stale) {
+			snapshot->users = SerializeUsers(names_.MakeAddUsers(), settings_.users_size);
+			names_version_ = names_.GetVersion();
+		}
+
+		if(turn_stale) {
+			// From the point of view of someone not in the queue. It goes in the urgent
+			// lane, ahead of the users, so it carries every username itself.
+			auto turn = turns_.MakeSnapshot(UserTable::None, now);
+			KnownNames nobody;
+			names_.Prepare(nobody, turn);
+			snapshot->turn = Serialize(turn);
+			turns_version_ = turns_.GetVersion();
+			turn_built_ = now;
+		}
+
+		if(cursor_stale_) {
+			snapshot->cursor = build_cursor_ ? build_cursor_() : nullptr;
+			cursor_stale_ = false;
+		}
+
+		if(display_stale_) {
+			snapshot->display = build_display_ ? build_display_() : nullptr;
+			display_stale_ = false;
+		}
+
+		snapshot_ = std::move(snapshot);
+		return snapshot_;
+	}
+
+} // namespace lydia::room
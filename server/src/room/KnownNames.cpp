@@ -0,0 +1,116 @@
+#include <lydia/room/KnownNames.h>
+
+namespace lydia::room {
+
+	void KnownNames::Clear() {
+		generations_.clear();
+	}
+
+	NameTable::NameTable(const UserTable& users)
+		: users_(users) {
+	}
+
+	const std::string* NameTable::Get(std::uint64_t uid) const {
+		const auto slot = users_.Find(uid);
+		if(slot == UserTable::None)
+			return nullptr;
+		return &users_.GetUsername(slot);
+	}
+
+	messages::UserReference NameTable::MakeReference(std::uint64_t uid) const {
+		messages::UserReference ref;
+		ref.uid = uid;
+
+		if(auto* username = Get(uid); username) {
+			messages::ReadableString string;
+			string = *username;
+			ref.username = string;
+		}
+
+		return ref;
+	}
+
+	messages::AddUsersMessage NameTable::MakeAddUsers() const {
+		messages::AddUsersMessage message;
+		auto& users = message.users.GetUnderlying();
+		users.reserve(users_.Size());
+
+		for(UserTable::Slot slot = 0; slot < users_.Capacity(); ++slot) {
+			if(!users_.IsUsed(slot))
+				continue;
+
+			auto& ref = users.emplace_back();
+			ref.uid = users_.GetUid(slot);
+
+			messages::ReadableString string;
+			string = users_.GetUsername(slot);
+			ref.username = string;
+		}
+
+		return message;
+	}
+
+	void NameTable::Learn(KnownNames& known) const {
+		known.generations_.resize(users_.Capacity());
+
+		for(UserTable::Slot slot = 0; slot < users_.Capacity(); ++slot)
+			known.generations_[slot] = users_.IsUsed(slot) ? users_.GetGeneration(slot) : 0;
+	}
+
+	std::uint64_t NameTable::GetVersion() const {
+		return users_.GetVersion();
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::UserReference& ref) const {
+		const auto slot = users_.Find(ref.uid);
+		if(slot == UserTable::None)
+			return;
+
+		const auto generation = users_.GetGeneration(slot);
+
+		if(known.generations_.size() <= slot)
+			known.generations_.resize(users_.Capacity());
+
+		if(known.generations_[slot] == generation) {
+			ref.username.Reset();
+			return;
+		}
+
+		messages::ReadableString string;
+		string = users_.GetUsername(slot);
+		ref.username = string;
+		known.generations_[slot] = generation;
+	}
+
+	void NameTable::Prepare(KnownNames& known, binproto::Array<messages::UserReference>& refs) const {
+		for(auto& ref : refs.GetUnderlying())
+			Prepare(known, ref);
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::AddUsersMessage& message) const {
+		Prepare(known, message.users);
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::UserRenameBroadcast& message) const {
+		Prepare(known, message.user);
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::TurnServerMessage& message) const {
+		Prepare(known, message.users);
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::TurnUpdateMessage& message) const {
+		if(message.user.HasValue())
+			Prepare(known, message.user.Value());
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::ChatServerMessage& message) const {
+		for(auto& line : message.lines.GetUnderlying())
+			Prepare(known, line.user);
+	}
+
+	void NameTable::Prepare(KnownNames& known, messages::ChatCreateWhisperChannelServerMessage& message) const {
+		Prepare(known, message.user);
+	}
+
+} // namespace lydia::room
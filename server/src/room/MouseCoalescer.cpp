@@ -0,0 +1,68 @@
+#include <lydia/room/MouseCoalescer.h>
+
+namespace lydia::room {
+
+	MouseCoalescer::MouseCoalescer(UserTable& users, ForwardFunction forward, BroadcastFunction broadcast, std::uint32_t tick_rate)
+		: users_(users),
+		  forward_(std::move(forward)),
+		  broadcast_(std::move(broadcast)) {
+		SetTickRate(tick_rate);
+	}
+
+	void MouseCoalescer::SetTickRate(std::uint32_t tick_rate) {
+		tick_rate_ = tick_rate == 0 ? 1 : tick_rate;
+	}
+
+	std::uint32_t MouseCoalescer::GetTickRate() const {
+		return tick_rate_;
+	}
+
+	std::chrono::nanoseconds MouseCoalescer::GetTickInterval() const {
+		return std::chrono::nanoseconds(std::chrono::seconds(1)) / tick_rate_;
+	}
+
+	void MouseCoalescer::OnMouse(UserTable::Slot slot, const messages::MouseMessage& message) {
+		if(!users_.IsUsed(slot))
+			return;
+
+		users_.SetCursor(slot, message.x, message.y);
+
+		// The hypervisor gets everything right away, so whoever has the turn doesn't wait for
+		// a tick to see their own pointer move; only what everyone else sees is coalesced.
+		if(forward_)
+			forward_(slot, message);
+
+		if(pending_.size() <= slot)
+			pending_.resize(users_.Capacity());
+
+		if(!pending_[slot]) {
+			pending_[slot] = true;
+			dirty_.push_back(slot);
+		}
+	}
+
+	void MouseCoalescer::RemoveUser(UserTable::Slot slot) {
+		// Any stale entry left in dirty_ is skipped by Tick().
+		if(slot < pending_.size())
+			pending_[slot] = false;
+	}
+
+	void MouseCoalescer::Tick() {
+		for(auto slot : dirty_) {
+			if(!pending_[slot])
+				continue;
+
+			pending_[slot] = false;
+
+			if(broadcast_ && users_.IsUsed(slot)) {
+				messages::MouseMoveMessage message;
+				message.x = users_.GetCursorX(slot);
+				message.y = users_.GetCursorY(slot);
+				broadcast_(slot, message);
+			}
+		}
+
+		dirty_.clear();
+	}
+
+} // namespace lydia::room
@@ -0,0 +1,247 @@
+#include <lydia/room/TurnQueue.h>
+
+#include <algorithm>
+
+namespace lydia::room {
+
+	TurnQueue::TurnQueue(UserTable& users, narwhal::TimerWheel& timers, std::chrono::milliseconds turn_length, BroadcastFunction broadcast)
+		: users_(users),
+		  turn_length_(turn_length),
+		  broadcast_(std::move(broadcast)),
+		  timers_(timers),
+		  timer_([this]() { OnTimer(Clock::now()); }) {
+	}
+
+	bool TurnQueue::Enqueue(UserTable::Slot slot, Clock::time_point now) {
+		if(!users_.IsUsed(slot) || IsQueued(slot))
+			return false;
+
+		if(nodes_.size() <= slot)
+			nodes_.resize(users_.Capacity());
+
+		auto& node = nodes_[slot];
+		node.prev = tail_;
+		node.next = UserTable::None;
+
+		if(tail_ != UserTable::None)
+			nodes_[tail_].next = slot;
+		tail_ = slot;
+
+		users_.SetTurnPosition(slot, static_cast<std::uint32_t>(size_));
+		++size_;
+
+		if(head_ == UserTable::None) {
+			head_ = slot;
+			StartTurn(now);
+			UpdateTimer();
+		}
+
+		Broadcast(messages::TurnUpdateMessage::Action::Enqueued, users_.GetUid(slot), now);
+		return true;
+	}
+
+	bool TurnQueue::Remove(UserTable::Slot slot, Clock::time_point now) {
+		if(!IsQueued(slot))
+			return false;
+
+		if(Unlink(slot)) {
+			StartTurn(now);
+			UpdateTimer();
+		}
+
+		Broadcast(messages::TurnUpdateMessage::Action::Removed, users_.GetUid(slot), now);
+		return true;
+	}
+
+	void TurnQueue::EndTurn(Clock::time_point now) {
+		if(head_ != UserTable::None)
+			Remove(head_, now);
+	}
+
+	void TurnQueue::Clear(Clock::time_point now) {
+		if(size_ == 0)
+			return;
+
+		for(auto slot = head_; slot != UserTable::None; slot = nodes_[slot].next)
+			users_.SetTurnPosition(slot, std::nullopt);
+
+		head_ = UserTable::None;
+		tail_ = UserTable::None;
+		size_ = 0;
+		UpdateTimer();
+
+		Broadcast(messages::TurnUpdateMessage::Action::Cleared, std::nullopt, now);
+	}
+
+	void TurnQueue::Pause(Clock::time_point now) {
+		if(paused_)
+			return;
+
+		paused_left_ = TimeLeft(now);
+		paused_ = true;
+		UpdateTimer();
+
+		Broadcast(messages::TurnUpdateMessage::Action::Paused, std::nullopt, now);
+	}
+
+	void TurnQueue::Resume(Clock::time_point now) {
+		if(!paused_)
+			return;
+
+		paused_ = false;
+		deadline_ = now + paused_left_;
+		UpdateTimer();
+
+		Broadcast(messages::TurnUpdateMessage::Action::Resumed, std::nullopt, now);
+	}
+
+	void TurnQueue::Administrate(const messages::TurnAdministrationMessage& message, Clock::time_point now) {
+		using Action = messages::TurnAdministrationMessage::Action;
+
+		switch(message.action) {
+			case Action::Pause:
+				Pause(now);
+				break;
+			case Action::Resume:
+				Resume(now);
+				break;
+			case Action::EndTurn:
+				EndTurn(now);
+				break;
+			case Action::Clear:
+				Clear(now);
+				break;
+		}
+	}
+
+	void TurnQueue::OnTimer(Clock::time_point now) {
+		if(paused_ || head_ == UserTable::None)
+			return;
+
+		// The wheel rounds to its tick, so we may be a hair early; just reschedule.
+		if(now < deadline_) {
+			UpdateTimer();
+			return;
+		}
+
+		EndTurn(now);
+	}
+
+	bool TurnQueue::IsPaused() const {
+		return paused_;
+	}
+
+	bool TurnQueue::IsQueued(UserTable::Slot slot) const {
+		return users_.IsUsed(slot) && users_.GetTurnPosition(slot).has_value();
+	}
+
+	std::size_t TurnQueue::Size() const {
+		return size_;
+	}
+
+	std::optional<std::uint64_t> TurnQueue::Current() const {
+		if(head_ == UserTable::None)
+			return std::nullopt;
+		return users_.GetUid(head_);
+	}
+
+	messages::TurnServerMessage TurnQueue::MakeSnapshot(UserTable::Slot viewer, Clock::time_point now) const {
+		messages::TurnServerMessage message;
+		auto& users = message.users.GetUnderlying();
+		users.reserve(size_);
+
+		for(auto slot = head_; slot != UserTable::None; slot = nodes_[slot].next) {
+			auto& ref = users.emplace_back();
+			ref.uid = users_.GetUid(slot);
+		}
+
+		const auto viewer_position = IsQueued(viewer) ? users_.GetTurnPosition(viewer) : std::nullopt;
+
+		auto left = TimeLeft(now);
+		if(users.empty())
+			left = std::chrono::milliseconds::zero();
+		else if(!viewer_position.has_value())
+			left += turn_length_ * (users.size() - 1);
+		else if(*viewer_position != 0)
+			left += turn_length_ * (*viewer_position - 1);
+
+		message.turn_ms = static_cast<std::uint32_t>(left.count());
+		message.paused = paused_;
+		return message;
+	}
+
+	std::uint64_t TurnQueue::GetVersion() const {
+		return version_;
+	}
+
+	bool TurnQueue::Unlink(UserTable::Slot slot) {
+		const bool was_head = slot == head_;
+		const auto& node = nodes_[slot];
+
+		if(node.prev != UserTable::None)
+			nodes_[node.prev].next = node.next;
+		else
+			head_ = node.next;
+
+		if(node.next != UserTable::None)
+			nodes_[node.next].prev = node.prev;
+		else
+			tail_ = node.prev;
+
+		for(auto behind = node.next; behind != UserTable::None; behind = nodes_[behind].next)
+			users_.SetTurnPosition(behind, *users_.GetTurnPosition(behind) - 1);
+
+		users_.SetTurnPosition(slot, std::nullopt);
+		--size_;
+		return was_head;
+	}
+
+	void TurnQueue::StartTurn(Clock::time_point now) {
+		if(head_ == UserTable::None)
+			return;
+
+		if(paused_)
+			paused_left_ = turn_length_;
+		else
+			deadline_ = now + turn_length_;
+	}
+
+	void TurnQueue::UpdateTimer() {
+		if(head_ != UserTable::None && !paused_)
+			timers_.Schedule(timer_, deadline_);
+		else
+			timer_.Cancel();
+	}
+
+	std::chrono::milliseconds TurnQueue::TimeLeft(Clock::time_point now) const {
+		if(head_ == UserTable::None)
+			return std::chrono::milliseconds::zero();
+
+		if(paused_)
+			return paused_left_;
+
+		return std::max(std::chrono::ceil<std::chrono::milliseconds>(deadline_ - now), std::chrono::milliseconds::zero());
+	}
+
+	void TurnQueue::Broadcast(messages::TurnUpdateMessage::Action action, std::optional<std::uint64_t> uid, Clock::time_point now) {
+		// Every change comes through here.
+		++version_;
+
+		if(!broadcast_)
+			return;
+
+		messages::TurnUpdateMessage message;
+		message.action = action;
+
+		if(uid.has_value()) {
+			messages::UserReference ref;
+			ref.uid = *uid;
+			message.user = ref;
+		}
+
+		message.turn_ms = static_cast<std::uint32_t>(TimeLeft(now).count());
+		message.turn_length_ms = static_cast<std::uint32_t>(turn_length_.count());
+		broadcast_(message);
+	}
+
+} // namespace lydia::room
@@ -0,0 +1,152 @@
+#include <lydia/room/UserTable.h>
+
+namespace lydia::room {
+
+	namespace {
+		/**
+		 * Bump a generation, skipping 0 (which callers use for "nothing").
+		 */
+		void Bump(std::uint32_t& generation) {
+			if(++generation == 0)
+				generation = 1;
+		}
+	} // namespace
+
+	UserTable::Slot UserTable::Add(std::uint64_t uid, std::uint64_t cid, const std::string& username) {
+		if(cid == 0 || slots_.contains(uid))
+			return None;
+
+		Slot slot;
+		if(!free_.empty()) {
+			slot = free_.back();
+			free_.pop_back();
+		} else {
+			slot = static_cast<Slot>(uids_.size());
+			uids_.push_back(0);
+			cids_.push_back(0);
+			usernames_.emplace_back();
+			generations_.push_back(0);
+			permissions_.push_back(Permissions::None);
+			cursor_x_.push_back(0);
+			cursor_y_.push_back(0);
+			turn_positions_.push_back(NotQueued);
+		}
+
+		uids_[slot] = uid;
+		cids_[slot] = cid;
+		usernames_[slot] = username;
+		Bump(generations_[slot]);
+		slots_[uid] = slot;
+		++version_;
+		return slot;
+	}
+
+	void UserTable::Remove(Slot slot) {
+		if(!IsUsed(slot))
+			return;
+
+		slots_.erase(uids_[slot]);
+
+		// Back to zeroes, so loops over a column see the slot as free. The generation
+		// stays, and is bumped again when the slot is reused.
+		uids_[slot] = 0;
+		cids_[slot] = 0;
+		usernames_[slot].clear();
+		permissions_[slot] = Permissions::None;
+		cursor_x_[slot] = 0;
+		cursor_y_[slot] = 0;
+		turn_positions_[slot] = NotQueued;
+
+		free_.push_back(slot);
+		++version_;
+	}
+
+	UserTable::Slot UserTable::Find(std::uint64_t uid) const {
+		const auto it = slots_.find(uid);
+		if(it == slots_.end())
+			return None;
+		return it->second;
+	}
+
+	std::size_t UserTable::Capacity() const {
+		return uids_.size();
+	}
+
+	std::size_t UserTable::Size() const {
+		return slots_.size();
+	}
+
+	bool UserTable::IsUsed(Slot slot) const {
+		return slot < cids_.size() && cids_[slot] != 0;
+	}
+
+	std::uint64_t UserTable::GetVersion() const {
+		return version_;
+	}
+
+	std::uint64_t UserTable::GetUid(Slot slot) const {
+		return uids_[slot];
+	}
+
+	std::uint64_t UserTable::GetConnection(Slot slot) const {
+		return cids_[slot];
+	}
+
+	const std::string& UserTable::GetUsername(Slot slot) const {
+		return usernames_[slot];
+	}
+
+	void UserTable::SetUsername(Slot slot, const std::string& username) {
+		if(usernames_[slot] == username)
+			return;
+
+		usernames_[slot] = username;
+		Bump(generations_[slot]);
+		++version_;
+	}
+
+	std::uint32_t UserTable::GetGeneration(Slot slot) const {
+		return generations_[slot];
+	}
+
+	UserTable::Permissions UserTable::GetPermissions(Slot slot) const {
+		return permissions_[slot];
+	}
+
+	void UserTable::SetPermissions(Slot slot, Permissions permissions) {
+		permissions_[slot] = permissions;
+	}
+
+	bool UserTable::Can(Slot slot, Permissions permissions) const {
+		const auto wanted = static_cast<std::uint8_t>(permissions);
+		return (static_cast<std::uint8_t>(permissions_[slot]) & wanted) == wanted;
+	}
+
+	std::uint16_t UserTable::GetCursorX(Slot slot) const {
+		return cursor_x_[slot];
+	}
+
+	std::uint16_t UserTable::GetCursorY(Slot slot) const {
+		return cursor_y_[slot];
+	}
+
+	void UserTable::SetCursor(Slot slot, std::uint16_t x, std::uint16_t y) {
+		cursor_x_[slot] = x;
+		cursor_y_[slot] = y;
+	}
+
+	std::optional<std::uint32_t> UserTable::GetTurnPosition(Slot slot) const {
+		if(turn_positions_[slot] == NotQueued)
+			return std::nullopt;
+		return turn_positions_[slot];
+	}
+
+	void UserTable::SetTurnPosition(Slot slot, std::optional<std::uint32_t> position) {
+		turn_positions_[slot] = position.value_or(NotQueued);
+	}
+
+	std::span<const std::uint64_t> UserTable::GetConnections() const {
+		return cids_;
+	}
+
+} // namespace lydia::room
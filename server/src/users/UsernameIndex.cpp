@@ -0,0 +1,265 @@
+#include <lydia/users/UsernameIndex.h>
+#include <lydia/users/UsernameKey.h>
+#include <narwhal/Hash.h>
+
+#include <algorithm>
+#include <bit>
+
+namespace lydia::users {
+
+	namespace {
+		constexpr std::uint64_t LowSeed = 0x4c7964696155736eull;
+		constexpr std::uint64_t HighSeed = 0x6e616d65496e6478ull;
+
+		constexpr std::size_t InitialCapacity = 64;
+
+		/**
+		 * RAII helper marking a shard write in progress, for the readers' benefit.
+		 */
+		struct WriteSection {
+			explicit WriteSection(std::atomic<std::uint32_t>& sequence)
+				: sequence(sequence) {
+				sequence.fetch_add(1, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_release);
+			}
+
+			~WriteSection() {
+				sequence.fetch_add(1, std::memory_order_release);
+			}
+
+			std::atomic<std::uint32_t>& sequence;
+		};
+	} // namespace
+
+	UsernameIndex::Table::Table(std::size_t capacity)
+		: mask(capacity - 1),
+		  slots(new Slot[capacity]) {
+	}
+
+	UsernameIndex::UsernameIndex(std::size_t shard_count)
+		: shards_(new Shard[std::bit_ceil(std::max<std::size_t>(shard_count, 1))]),
+		  shard_mask_(std::bit_ceil(std::max<std::size_t>(shard_count, 1)) - 1) {
+		for(std::size_t i = 0; i <= shard_mask_; ++i) {
+			auto& shard = shards_[i];
+			shard.tables.push_back(std::make_unique<Table>(InitialCapacity));
+			shard.table.store(shard.tables.back().get(), std::memory_order_release);
+		}
+	}
+
+	UsernameIndex::~UsernameIndex() = default;
+
+	UsernameIndex::Result UsernameIndex::Claim(std::string_view username, std::uint64_t uid) {
+		auto result = Result::Success;
+		auto hash = HashUsername(username, result);
+		if(!hash.has_value())
+			return result;
+
+		auto& shard = ShardFor(*hash);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		if(auto* slot = Find(*shard.table.load(std::memory_order_relaxed), *hash); slot) {
+			if(slot->owner.load(std::memory_order_relaxed) == uid)
+				return Result::Success;
+			return Result::UsernameTaken;
+		}
+
+		{
+			WriteSection write(shard.sequence);
+			MaybeGrow(shard);
+			Insert(*shard.table.load(std::memory_order_relaxed), *hash, uid);
+		}
+
+		++shard.size;
+		size_.fetch_add(1, std::memory_order_relaxed);
+		return Result::Success;
+	}
+
+	bool UsernameIndex::Release(std::string_view username, std::uint64_t uid) {
+		auto result = Result::Success;
+		auto hash = HashUsername(username, result);
+		if(!hash.has_value())
+			return false;
+
+		auto& shard = ShardFor(*hash);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+
+		auto& table = *shard.table.load(std::memory_order_relaxed);
+		auto* slot = Find(table, *hash);
+		if(!slot || slot->owner.load(std::memory_order_relaxed) != uid)
+			return false;
+
+		{
+			WriteSection write(shard.sequence);
+			Erase(table, slot);
+		}
+
+		--shard.size;
+		size_.fetch_sub(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	UsernameIndex::Result UsernameIndex::Rename(std::string_view from, std::string_view to, std::uint64_t uid) {
+		auto result = Result::Success;
+		auto from_hash = HashUsername(from, result);
+		auto to_hash = HashUsername(to, result);
+		if(!to_hash.has_value())
+			return result;
+
+		// Same key (e.g. only the case changed), so there's nothing to swap.
+		if(from_hash.has_value() && from_hash->low == to_hash->low && from_hash->high == to_hash->high)
+			return Claim(to, uid);
+
+		result = Claim(to, uid);
+		if(result == Result::Success)
+			Release(from, uid);
+		return result;
+	}
+
+	std::optional<std::uint64_t> UsernameIndex::Owner(std::string_view username) const {
+		auto result = Result::Success;
+		auto hash = HashUsername(username, result);
+		if(!hash.has_value())
+			return std::nullopt;
+
+		auto& shard = ShardFor(*hash);
+
+		while(true) {
+			const auto sequence = shard.sequence.load(std::memory_order_acquire);
+			if(sequence & 1)
+				continue;
+
+			const auto& table = *shard.table.load(std::memory_order_acquire);
+			std::optional<std::uint64_t> owner;
+
+			// Bounded by the table size in case we're looking at a half-written table;
+			// the sequence check below throws such a result away anyways.
+			auto index = hash->low & table.mask;
+			for(std::size_t probes = 0; probes <= table.mask; ++probes, index = (index + 1) & table.mask) {
+				const auto& slot = table.slots[index];
+				const auto low = slot.low.load(std::memory_order_relaxed);
+
+				if(low == 0)
+					break;
+
+				if(low == hash->low && slot.high.load(std::memory_order_relaxed) == hash->high) {
+					owner = slot.owner.load(std::memory_order_relaxed);
+					break;
+				}
+			}
+
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if(shard.sequence.load(std::memory_order_relaxed) == sequence)
+				return owner;
+		}
+	}
+
+	std::size_t UsernameIndex::Size() const {
+		return size_.load(std::memory_order_relaxed);
+	}
+
+	std::optional<UsernameIndex::Hash> UsernameIndex::HashUsername(std::string_view username, Result& result) {
+		if(CodePointCount(username) > MaxUsernameLength) {
+			result = Result::UsernameTooLong;
+			return std::nullopt;
+		}
+
+		auto key = MakeUsernameKey(username);
+		if(!key.has_value() || key->empty()) {
+			result = Result::UsernameInvalid;
+			return std::nullopt;
+		}
+
+		Hash hash;
+		hash.low = narwhal::Hash64(*key, LowSeed);
+		hash.high = narwhal::Hash64(*key, HighSeed);
+
+		// 0 marks an empty slot.
+		if(hash.low == 0)
+			hash.low = 1;
+
+		return hash;
+	}
+
+	UsernameIndex::Shard& UsernameIndex::ShardFor(const Hash& hash) const {
+		// Slots are picked by the low hash, so pick shards by the high one.
+		return shards_[(hash.high >> 32) & shard_mask_];
+	}
+
+	UsernameIndex::Slot* UsernameIndex::Find(Table& table, const Hash& hash) {
+		for(auto index = hash.low & table.mask;; index = (index + 1) & table.mask) {
+			auto& slot = table.slots[index];
+			const auto low = slot.low.load(std::memory_order_relaxed);
+
+			if(low == 0)
+				return nullptr;
+
+			if(low == hash.low && slot.high.load(std::memory_order_relaxed) == hash.high)
+				return &slot;
+		}
+	}
+
+	void UsernameIndex::Insert(Table& table, const Hash& hash, std::uint64_t uid) {
+		auto index = hash.low & table.mask;
+		while(table.slots[index].low.load(std::memory_order_relaxed) != 0)
+			index = (index + 1) & table.mask;
+
+		auto& slot = table.slots[index];
+		slot.high.store(hash.high, std::memory_order_relaxed);
+		slot.owner.store(uid, std::memory_order_relaxed);
+		slot.low.store(hash.low, std::memory_order_relaxed);
+	}
+
+	void UsernameIndex::Erase(Table& table, Slot* slot) {
+		auto hole = static_cast<std::size_t>(slot - table.slots.get());
+		auto index = hole;
+
+		while(true) {
+			index = (index + 1) & table.mask;
+
+			auto& next = table.slots[index];
+			const auto low = next.low.load(std::memory_order_relaxed);
+			if(low == 0)
+				break;
+
+			// Leave the slot where it is if its home is cyclically within (hole, index].
+			const auto home = low & table.mask;
+			const bool stays = hole <= index ? (hole < home && home <= index) : (hole < home || home <= index);
+			if(stays)
+				continue;
+
+			auto& target = table.slots[hole];
+			target.high.store(next.high.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			target.owner.store(next.owner.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			target.low.store(low, std::memory_order_relaxed);
+			hole = index;
+		}
+
+		table.slots[hole].low.store(0, std::memory_order_relaxed);
+	}
+
+	void UsernameIndex::MaybeGrow(Shard& shard) {
+		auto& table = *shard.table.load(std::memory_order_relaxed);
+		const auto capacity = table.mask + 1;
+
+		// Keep the load factor at or under 1/2.
+		if((shard.size + 1) * 2 <= capacity)
+			return;
+
+		auto grown = std::make_unique<Table>(capacity * 2);
+		for(std::size_t i = 0; i < capacity; ++i) {
+			const auto& slot = table.slots[i];
+			const auto low = slot.low.load(std::memory_order_relaxed);
+			if(low == 0)
+				continue;
+
+			Hash hash;
+			hash.low = low;
+			hash.high = slot.high.load(std::memory_order_relaxed);
+			Insert(*grown, hash, slot.owner.load(std::memory_order_relaxed));
+		}
+
+		shard.table.store(grown.get(), std::memory_order_release);
+		shard.tables.push_back(std::move(grown));
+	}
+
+} // namespace lydia::users
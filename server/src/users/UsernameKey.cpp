@@ -0,0 +1,351 @@
+#include <lydia/users/UsernameKey.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+
+namespace lydia::users {
+
+	namespace {
+		using namespace std::string_view_literals;
+
+		constexpr char32_t BadCodePoint = 0xFFFFFFFF;
+
+		/**
+		 * Decode a single code point, advancing the index past it.
+		 * Returns BadCodePoint for malformed, overlong or surrogate sequences.
+		 */
+		char32_t Decode(std::string_view string, std::size_t& index) {
+			const auto lead = static_cast<std::uint8_t>(string[index++]);
+			if(lead < 0x80)
+				return lead;
+
+			std::size_t length;
+			char32_t cp;
+			char32_t min;
+
+			if((lead & 0xE0) == 0xC0) {
+				length = 1;
+				cp = lead & 0x1F;
+				min = 0x80;
+			} else if((lead & 0xF0) == 0xE0) {
+				length = 2;
+				cp = lead & 0x0F;
+				min = 0x800;
+			} else if((lead & 0xF8) == 0xF0) {
+				length = 3;
+				cp = lead & 0x07;
+				min = 0x10000;
+			} else {
+				return BadCodePoint;
+			}
+
+			if(index + length > string.size())
+				return BadCodePoint;
+
+			for(std::size_t i = 0; i < length; ++i) {
+				const auto byte = static_cast<std::uint8_t>(string[index++]);
+				if((byte & 0xC0) != 0x80)
+					return BadCodePoint;
+				cp = (cp << 6) | (byte & 0x3F);
+			}
+
+			if(cp < min || cp > 0x10FFFF || (cp >= 0xD800 && cp <= 0xDFFF))
+				return BadCodePoint;
+
+			return cp;
+		}
+
+		void Encode(char32_t cp, std::string& out) {
+			if(cp < 0x80) {
+				out += static_cast<char>(cp);
+			} else if(cp < 0x800) {
+				out += static_cast<char>(0xC0 | (cp >> 6));
+				out += static_cast<char>(0x80 | (cp & 0x3F));
+			} else if(cp < 0x10000) {
+				out += static_cast<char>(0xE0 | (cp >> 12));
+				out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (cp & 0x3F));
+			} else {
+				out += static_cast<char>(0xF0 | (cp >> 18));
+				out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+				out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+				out += static_cast<char>(0x80 | (cp & 0x3F));
+			}
+		}
+
+		// Base letters for U+00C0..U+00FF and U+0100..U+017F.
+		// '\0' means "no mapping", and '1' to '4' are ligatures expanding to two letters.
+
+		constexpr std::string_view Latin1Bases =
+		"aaaaaa3ceeeeiiii"	 // U+00C0
+		"dnooooo\0ouuuuy\0" // U+00D0
+		"4aaaaaa3ceeeeiiii" // U+00DF..U+00EF
+		"dnooooo\0ouuuuy\0y"sv; // U+00F0
+
+		constexpr std::string_view LatinExtendedABases =
+		"aaaaaa"
+		"cccccccc"
+		"dddd"
+		"eeeeeeeeee"
+		"gggggggg"
+		"hhhh"
+		"iiiiiiiiii"
+		"11"
+		"jj"
+		"kkk"
+		"llllllllll"
+		"nnnnnnnnn"
+		"oooooo"
+		"22"
+		"rrrrrr"
+		"ssssssss"
+		"tttttt"
+		"uuuuuuuuuuuu"
+		"ww"
+		"yyy"
+		"zzzzzz"
+		"s"sv;
+
+		static_assert(Latin1Bases.size() == 0x40);
+		static_assert(LatinExtendedABases.size() == 0x80);
+
+		constexpr std::string_view Ligature(char c) {
+			switch(c) {
+				case '1':
+					return "ij";
+				case '2':
+					return "oe";
+				case '3':
+					return "ae";
+				case '4':
+					return "ss";
+				default:
+					return {};
+			}
+		}
+
+		/**
+		 * Characters which are dropped from keys entirely:
+		 * combining marks, zero-width characters, bidi controls, variation selectors and so on.
+		 */
+		constexpr bool IsIgnorable(char32_t cp) {
+			return (cp >= 0x0300 && cp <= 0x036F) || cp == 0x00AD || cp == 0x034F || (cp >= 0x200B && cp <= 0x200F) || (cp >= 0x202A && cp <= 0x202E) || (cp >= 0x2060 && cp <= 0x2064) || (cp >= 0xFE00 && cp <= 0xFE0F) || cp == 0xFEFF;
+		}
+
+		constexpr bool IsSpace(char32_t cp) {
+			return cp == ' ' || cp == 0x00A0 || (cp >= 0x2000 && cp <= 0x200A) || cp == 0x2028 || cp == 0x2029 || cp == 0x202F || cp == 0x205F || cp == 0x3000;
+		}
+
+		constexpr bool IsControl(char32_t cp) {
+			return cp < 0x20 || (cp >= 0x7F && cp <= 0x9F);
+		}
+
+		/**
+		 * Simple case folding for the scripts not covered by the base letter tables.
+		 */
+		constexpr char32_t Fold(char32_t cp) {
+			// Greek
+			if(cp == 0x0386)
+				return 0x03AC;
+			if(cp >= 0x0388 && cp <= 0x038A)
+				return cp + 37;
+			if(cp == 0x038C)
+				return 0x03CC;
+			if(cp == 0x038E || cp == 0x038F)
+				return cp + 63;
+			if((cp >= 0x0391 && cp <= 0x03A1) || (cp >= 0x03A3 && cp <= 0x03AB))
+				return cp + 32;
+			if(cp == 0x03C2)
+				return 0x03C3;
+
+			// Cyrillic
+			if(cp >= 0x0400 && cp <= 0x040F)
+				return cp + 80;
+			if(cp >= 0x0410 && cp <= 0x042F)
+				return cp + 32;
+			if(cp == 0x04C0)
+				return 0x04CF;
+			if(((cp >= 0x0460 && cp <= 0x0481) || (cp >= 0x048A && cp <= 0x04BF) || (cp >= 0x04D0 && cp <= 0x052F)) && !(cp & 1))
+				return cp + 1;
+			if(cp >= 0x04C1 && cp <= 0x04CE && (cp & 1))
+				return cp + 1;
+
+			// Armenian
+			if(cp >= 0x0531 && cp <= 0x0556)
+				return cp + 48;
+
+			// Latin Extended Additional
+			if(((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF)) && !(cp & 1))
+				return cp + 1;
+
+			return cp;
+		}
+
+		/**
+		 * Lowercase letters of other scripts which look like a Latin letter.
+		 */
+		constexpr auto Confusables = [] {
+			std::array<std::pair<char32_t, char>, 43> table { {
+			// Greek
+			{ 0x03B1, 'a' },
+			{ 0x03B2, 'b' },
+			{ 0x03B5, 'e' },
+			{ 0x03B6, 'z' },
+			{ 0x03B7, 'h' },
+			{ 0x03B9, 'i' },
+			{ 0x03BA, 'k' },
+			{ 0x03BC, 'm' },
+			{ 0x03BD, 'n' },
+			{ 0x03BF, 'o' },
+			{ 0x03C1, 'p' },
+			{ 0x03C4, 't' },
+			{ 0x03C5, 'y' },
+			{ 0x03C7, 'x' },
+			{ 0x03F2, 'c' },
+			{ 0x03F3, 'j' },
+
+			// Cyrillic
+			{ 0x0430, 'a' },
+			{ 0x0432, 'b' },
+			{ 0x0435, 'e' },
+			{ 0x043A, 'k' },
+			{ 0x043C, 'm' },
+			{ 0x043D, 'h' },
+			{ 0x043E, 'o' },
+			{ 0x0440, 'p' },
+			{ 0x0441, 'c' },
+			{ 0x0442, 't' },
+			{ 0x0443, 'y' },
+			{ 0x0445, 'x' },
+			{ 0x0451, 'e' },
+			{ 0x0455, 's' },
+			{ 0x0456, 'i' },
+			{ 0x0457, 'i' },
+			{ 0x0458, 'j' },
+			{ 0x04AF, 'y' },
+			{ 0x04BB, 'h' },
+			{ 0x04CF, 'l' },
+			{ 0x0501, 'd' },
+			{ 0x051B, 'q' },
+			{ 0x051D, 'w' },
+
+			// Armenian
+			{ 0x0570, 'h' },
+			{ 0x0578, 'n' },
+			{ 0x057D, 'u' },
+			{ 0x0585, 'o' },
+			} };
+
+			std::sort(table.begin(), table.end());
+			return table;
+		}();
+
+		/**
+		 * Append an ASCII character to the key, folding case and lookalike characters.
+		 * "i", "l", "1" and "|" are all one class, as are "o" and "0".
+		 */
+		void PutAscii(char c, std::string& key) {
+			if(c >= 'A' && c <= 'Z')
+				c = static_cast<char>(c - 'A' + 'a');
+
+			switch(c) {
+				case 'i':
+				case '1':
+				case '|':
+					c = 'l';
+					break;
+				case '0':
+					c = 'o';
+					break;
+				default:
+					break;
+			}
+
+			key += c;
+		}
+
+		void Put(char32_t cp, std::string& key) {
+			// Fullwidth forms of ASCII
+			if(cp >= 0xFF01 && cp <= 0xFF5E)
+				cp -= 0xFEE0;
+
+			if(cp < 0x80)
+				return PutAscii(static_cast<char>(cp), key);
+
+			char base = '\0';
+			if(cp >= 0x00C0 && cp <= 0x00FF)
+				base = Latin1Bases[cp - 0x00C0];
+			else if(cp >= 0x0100 && cp <= 0x017F)
+				base = LatinExtendedABases[cp - 0x0100];
+			else if(cp == 0x1E9E)
+				base = '4';
+
+			if(base != '\0') {
+				if(auto ligature = Ligature(base); !ligature.empty()) {
+					for(auto c : ligature)
+						PutAscii(c, key);
+				} else {
+					PutAscii(base, key);
+				}
+				return;
+			}
+
+			cp = Fold(cp);
+
+			auto it = std::lower_bound(Confusables.begin(), Confusables.end(), cp, [](const auto& entry, char32_t value) {
+				return entry.first < value;
+			});
+
+			if(it != Confusables.end() && it->first == cp)
+				return PutAscii(it->second, key);
+
+			Encode(cp, key);
+		}
+	} // namespace
+
+	std::optional<std::string> MakeUsernameKey(std::string_view username) {
+		std::string key;
+		key.reserve(username.size());
+
+		bool pending_space = false;
+		std::size_t index = 0;
+
+		while(index < username.size()) {
+			const auto cp = Decode(username, index);
+
+			if(cp == BadCodePoint || IsControl(cp))
+				return std::nullopt;
+
+			if(IsIgnorable(cp))
+				continue;
+
+			// Collapse runs of spaces, and trim them from both ends.
+			if(IsSpace(cp)) {
+				pending_space = !key.empty();
+				continue;
+			}
+
+			if(pending_space) {
+				key += ' ';
+				pending_space = false;
+			}
+
+			Put(cp, key);
+		}
+
+		return key;
+	}
+
+	std::size_t CodePointCount(std::string_view string) {
+		std::size_t count = 0;
+		for(auto c : string) {
+			// Count everything except continuation bytes.
+			if((static_cast<std::uint8_t>(c) & 0xC0) != 0x80)
+				++count;
+		}
+		return count;
+	}
+
+} // namespace lydia::users
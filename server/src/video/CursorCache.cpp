@@ -0,0 +1,132 @@
+#include <lydia/video/CursorCache.h>
+#include <narwhal/Hash.h>
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace lydia::video {
+
+	void KnownCursors::Clear() {
+		generations_.fill(0);
+	}
+
+	std::uint32_t CursorCache::Intern(const std::uint8_t* rgba, std::uint16_t width, std::uint16_t height, std::uint16_t hotspot_x, std::uint16_t hotspot_y) {
+		if(width == 0 || height == 0)
+			return 0;
+
+		// Too big a cursor is clipped rather than dropped (which would hide it), keeping the
+		// part around the hotspot, since that's the part which points at something.
+		std::vector<std::uint8_t> clipped;
+		if(width > MaxSize || height > MaxSize) {
+			const auto window = [](std::uint16_t size, std::uint16_t hotspot) -> std::uint16_t {
+				if(size <= MaxSize)
+					return 0;
+				return static_cast<std::uint16_t>(std::clamp(hotspot - MaxSize / 2, 0, size - MaxSize));
+			};
+
+			const auto x = window(width, hotspot_x);
+			const auto y = window(height, hotspot_y);
+			const auto clipped_width = std::min(width, MaxSize);
+			const auto clipped_height = std::min(height, MaxSize);
+
+			clipped.resize(static_cast<std::size_t>(clipped_width) * clipped_height * 4);
+			for(std::uint16_t row = 0; row < clipped_height; ++row)
+				std::memcpy(&clipped[static_cast<std::size_t>(row) * clipped_width * 4], rgba + ((static_cast<std::size_t>(y) + row) * width + x) * 4, static_cast<std::size_t>(clipped_width) * 4);
+
+			rgba = clipped.data();
+			width = clipped_width;
+			height = clipped_height;
+			hotspot_x = static_cast<std::uint16_t>(std::min(hotspot_x - x, clipped_width - 1));
+			hotspot_y = static_cast<std::uint16_t>(std::min(hotspot_y - y, clipped_height - 1));
+		}
+
+		const auto size = static_cast<std::size_t>(width) * height * 4;
+
+		// The geometry goes into the seed, so the same pixels at another size or hotspot are another shape.
+		const auto seed = (static_cast<std::uint64_t>(width) << 48) | (static_cast<std::uint64_t>(height) << 32) | (static_cast<std::uint64_t>(hotspot_x) << 16) | hotspot_y;
+		const auto hash = narwhal::Hash64(rgba, size, seed);
+
+		for(std::size_t slot = 0; slot < entries_.size(); ++slot) {
+			auto& entry = entries_[slot];
+			const auto& image = entry.image;
+			if(entry.hash != hash || image.width != width || image.height != height || image.hotspot_x != hotspot_x || image.hotspot_y != hotspot_y)
+				continue;
+
+			if(std::memcmp(entry.rgba.data(), rgba, size) != 0)
+				continue;
+
+			entry.last_used = ++clock_;
+			return static_cast<std::uint32_t>(slot + 1);
+		}
+
+		Entry* entry;
+		if(entries_.size() < MaxCursors) {
+			entry = &entries_.emplace_back();
+		} else {
+			entry = &*std::min_element(entries_.begin(), entries_.end(), [](const Entry& a, const Entry& b) {
+				return a.last_used < b.last_used;
+			});
+		}
+
+		// 0 is reserved for "not known".
+		if(++entry->generation == 0)
+			entry->generation = 1;
+		entry->hash = hash;
+		entry->rgba.assign(rgba, rgba + size);
+		entry->image.width = width;
+		entry->image.height = height;
+		entry->image.hotspot_x = hotspot_x;
+		entry->image.hotspot_y = hotspot_y;
+		entry->last_used = ++clock_;
+		Compress(*entry);
+
+		return static_cast<std::uint32_t>(entry - entries_.data() + 1);
+	}
+
+	bool CursorCache::Prepare(KnownCursors& known, std::uint32_t id, messages::MouseCursorUpdateMessage& message) const {
+		message.hidden = id == 0;
+		message.cursor_id = id;
+		message.cursor_image.Reset();
+
+		if(id == 0)
+			return true;
+
+		if(id > entries_.size())
+			return false;
+
+		const auto slot = id - 1;
+		const auto& entry = entries_[slot];
+
+		// The client has this slot's shape already, unless the slot has had another one since.
+		if(known.generations_[slot] == entry.generation)
+			return true;
+
+		known.generations_[slot] = entry.generation;
+		message.cursor_image = entry.image;
+		return true;
+	}
+
+	std::size_t CursorCache::Size() const {
+		return entries_.size();
+	}
+
+	void CursorCache::Compress(Entry& entry) {
+		// Cursors are mostly transparent or flat, so they deflate very well.
+		// It's done once per shape, so the best compression level is affordable.
+		auto& data = entry.image.data.GetUnderlying();
+		auto length = compressBound(entry.rgba.size());
+		data.resize(length);
+
+		if(compress2(data.data(), &length, entry.rgba.data(), entry.rgba.size(), Z_BEST_COMPRESSION) == Z_OK && length < entry.rgba.size()) {
+			data.resize(length);
+			entry.image.encoding = messages::CursorImage::Encoding::Zlib;
+			return;
+		}
+
+		data = entry.rgba;
+		entry.image.encoding = messages::CursorImage::Encoding::Raw;
+	}
+
+} // namespace lydia::video
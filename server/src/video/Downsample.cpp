@@ -0,0 +1,131 @@
+#include <lydia/video/Downsample.h>
+
+#include <algorithm>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define LYDIA_DOWNSAMPLE_X86
+#endif
+
+namespace lydia::video {
+
+	namespace {
+		/**
+		 * Adds each byte of a row to its 32-bit column sum.
+		 */
+		using AccumulateFunction = void (*)(const std::uint8_t* row, std::size_t bytes, std::uint32_t* sums);
+
+		void AccumulateScalar(const std::uint8_t* row, std::size_t bytes, std::uint32_t* sums) {
+			for(std::size_t i = 0; i < bytes; ++i)
+				sums[i] += row[i];
+		}
+
+#ifdef LYDIA_DOWNSAMPLE_X86
+		__attribute__((target("sse2"))) void AccumulateSse2(const std::uint8_t* row, std::size_t bytes, std::uint32_t* sums) {
+			const auto zero = _mm_setzero_si128();
+			std::size_t i = 0;
+
+			for(; i + 16 <= bytes; i += 16) {
+				const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+				const auto lo = _mm_unpacklo_epi8(data, zero);
+				const auto hi = _mm_unpackhi_epi8(data, zero);
+
+				auto* s = reinterpret_cast<__m128i*>(sums + i);
+				_mm_storeu_si128(s, _mm_add_epi32(_mm_loadu_si128(s), _mm_unpacklo_epi16(lo, zero)));
+				_mm_storeu_si128(s + 1, _mm_add_epi32(_mm_loadu_si128(s + 1), _mm_unpackhi_epi16(lo, zero)));
+				_mm_storeu_si128(s + 2, _mm_add_epi32(_mm_loadu_si128(s + 2), _mm_unpacklo_epi16(hi, zero)));
+				_mm_storeu_si128(s + 3, _mm_add_epi32(_mm_loadu_si128(s + 3), _mm_unpackhi_epi16(hi, zero)));
+			}
+
+			AccumulateScalar(row + i, bytes - i, sums + i);
+		}
+
+		__attribute__((target("avx2"))) void AccumulateAvx2(const std::uint8_t* row, std::size_t bytes, std::uint32_t* sums) {
+			std::size_t i = 0;
+
+			for(; i + 16 <= bytes; i += 16) {
+				auto* s = reinterpret_cast<__m256i*>(sums + i);
+				const auto lo = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + i)));
+				const auto hi = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(row + i + 8)));
+				_mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s), lo));
+				_mm256_storeu_si256(s + 1, _mm256_add_epi32(_mm256_loadu_si256(s + 1), hi));
+			}
+
+			AccumulateScalar(row + i, bytes - i, sums + i);
+		}
+#endif
+
+		struct Kernel {
+			AccumulateFunction accumulate { &AccumulateScalar };
+			const char* name { "scalar" };
+
+			Kernel() {
+#ifdef LYDIA_DOWNSAMPLE_X86
+				__builtin_cpu_init();
+				if(__builtin_cpu_supports("avx2")) {
+					accumulate = &AccumulateAvx2;
+					name = "avx2";
+				} else if(__builtin_cpu_supports("sse2")) {
+					accumulate = &AccumulateSse2;
+					name = "sse2";
+				}
+#endif
+			}
+		};
+
+		const Kernel& GetKernel() {
+			static const Kernel kernel;
+			return kernel;
+		}
+
+		/**
+		 * Get the source range [begin, end) destination index i covers. Never empty.
+		 */
+		std::pair<std::uint32_t, std::uint32_t> BoxRange(std::uint32_t i, std::uint32_t source, std::uint32_t destination) {
+			const auto begin = static_cast<std::uint32_t>(static_cast<std::uint64_t>(i) * source / destination);
+			const auto end = static_cast<std::uint32_t>(static_cast<std::uint64_t>(i + 1) * source / destination);
+			return { begin, std::max(end, begin + 1) };
+		}
+
+	} // namespace
+
+	void Downsample(const FramebufferView& frame, std::uint8_t* out, std::uint32_t width, std::uint32_t height, std::size_t stride) {
+		if(width == 0 || height == 0 || frame.width == 0 || frame.height == 0)
+			return;
+
+		const auto accumulate = GetKernel().accumulate;
+		const auto row_bytes = static_cast<std::size_t>(frame.width) * BytesPerPixel;
+
+		// Sum each output row's band of source rows column by column (the part that touches
+		// every source pixel, so it's the vectorised part), then sum the columns of each box.
+		std::vector<std::uint32_t> columns(row_bytes);
+
+		for(std::uint32_t y = 0; y < height; ++y) {
+			const auto [y0, y1] = BoxRange(y, frame.height, height);
+
+			std::fill(columns.begin(), columns.end(), 0);
+			for(auto sy = y0; sy < y1; ++sy)
+				accumulate(frame.Row(sy), row_bytes, columns.data());
+
+			auto* pixel = out + y * stride;
+			for(std::uint32_t x = 0; x < width; ++x, pixel += BytesPerPixel) {
+				const auto [x0, x1] = BoxRange(x, frame.width, width);
+
+				std::uint32_t sum[BytesPerPixel] {};
+				for(auto sx = x0; sx < x1; ++sx)
+					for(std::size_t c = 0; c < BytesPerPixel; ++c)
+						sum[c] += columns[sx * BytesPerPixel + c];
+
+				const auto count = (x1 - x0) * (y1 - y0);
+				for(std::size_t c = 0; c < BytesPerPixel; ++c)
+					pixel[c] = static_cast<std::uint8_t>((sum[c] + count / 2) / count);
+			}
+		}
+	}
+
+	const char* DownsampleKernelName() {
+		return GetKernel().name;
+	}
+
+} // namespace lydia::video
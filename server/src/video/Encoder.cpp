@@ -0,0 +1,363 @@
+#include <lydia/video/Encoder.h>
+#include <narwhal/PixelKernels.h>
+
+#include <algorithm>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <new>
+
+#include <jpeglib.h>
+#include <zlib.h>
+
+#ifdef LYDIA_HAVE_WEBP
+	#include <webp/encode.h>
+#endif
+
+namespace lydia::video {
+
+	namespace {
+		/**
+		 * Below this many pixels a rect isn't worth a lossy codec's overhead.
+		 */
+		constexpr std::size_t MinLossyArea = 32 * 32;
+
+		/**
+		 * ChooseEncoding() looks at about this many pixels per axis.
+		 */
+		constexpr std::uint32_t SamplesPerAxis = 32;
+
+		/**
+		 * At or under this many distinct colours in the sample, a rect is text-like.
+		 */
+		constexpr std::size_t MaxTextColors = 32;
+
+		constexpr std::size_t JpegInitialBuffer = 64 * 1024;
+
+		constexpr int ZlibLevel = 1;
+
+		std::uint32_t LoadPixel(const std::uint8_t* p) {
+			std::uint32_t pixel;
+			std::memcpy(&pixel, p, sizeof(pixel));
+			return pixel & 0x00FFFFFF;
+		}
+
+		/**
+		 * libjpeg error manager which jumps back into EncodeJpeg() instead of exiting the process.
+		 */
+		struct JpegError {
+			jpeg_error_mgr manager;
+			std::jmp_buf jump;
+		};
+
+		void JpegErrorExit(j_common_ptr cinfo) {
+			auto* error = reinterpret_cast<JpegError*>(cinfo->err);
+			std::longjmp(error->jump, 1);
+		}
+
+		void JpegOutputMessage(j_common_ptr) {
+			// Warnings aren't interesting.
+		}
+
+		/**
+		 * libjpeg destination manager which writes straight into the DisplayRect's buffer.
+		 */
+		struct JpegDestination {
+			jpeg_destination_mgr manager;
+			std::vector<std::uint8_t>* out;
+		};
+
+		void JpegInitDestination(j_compress_ptr cinfo) {
+			auto* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+			dest->out->resize(std::max(dest->out->capacity(), JpegInitialBuffer));
+			dest->manager.next_output_byte = dest->out->data();
+			dest->manager.free_in_buffer = dest->out->size();
+		}
+
+		boolean JpegEmptyOutputBuffer(j_compress_ptr cinfo) {
+			auto* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+			const auto used = dest->out->size();
+			dest->out->resize(used * 2);
+			dest->manager.next_output_byte = dest->out->data() + used;
+			dest->manager.free_in_buffer = dest->out->size() - used;
+			return TRUE;
+		}
+
+		void JpegTermDestination(j_compress_ptr cinfo) {
+			auto* dest = reinterpret_cast<JpegDestination*>(cinfo->dest);
+			dest->out->resize(dest->out->size() - dest->manager.free_in_buffer);
+		}
+
+#ifdef LYDIA_HAVE_WEBP
+		int WebPWriteToVector(const std::uint8_t* data, std::size_t size, const WebPPicture* picture) {
+			auto* out = static_cast<std::vector<std::uint8_t>*>(picture->custom_ptr);
+			out->insert(out->end(), data, data + size);
+			return 1;
+		}
+#endif
+	} // namespace
+
+	struct Encoder::Codecs {
+		z_stream zlib {};
+
+		jpeg_compress_struct jpeg {};
+		JpegError jpeg_error {};
+		JpegDestination jpeg_destination {};
+
+		/**
+		 * Row pointers for libjpeg.
+		 */
+		std::vector<JSAMPROW> rows;
+
+#ifdef LYDIA_HAVE_WEBP
+		WebPConfig webp_lossy {};
+		WebPConfig webp_lossless {};
+#endif
+	};
+
+	bool Encoder::HasWebP() {
+#ifdef LYDIA_HAVE_WEBP
+		return true;
+#else
+		return false;
+#endif
+	}
+
+	bool Encoder::IsTextLike(const FramebufferView& frame, const Rect& rect) {
+		const auto step_x = std::max<std::uint32_t>(rect.width / SamplesPerAxis, 1);
+		const auto step_y = std::max<std::uint32_t>(rect.height / SamplesPerAxis, 1);
+
+		// A tiny open addressing set; 0 marks an empty slot, so colours are stored with bit 24 set.
+		std::uint32_t colors[MaxTextColors * 4] {};
+		std::size_t distinct = 0;
+
+		std::size_t samples = 0;
+		std::size_t runs = 0;
+
+		for(auto y = rect.y; y < rect.y + rect.height; y += step_y) {
+			const auto* row = frame.Row(y);
+
+			// Each sample is a pixel and its right neighbour.
+			for(auto x = rect.x; x + 1 < rect.x + rect.width; x += step_x) {
+				const auto pixel = LoadPixel(row + x * BytesPerPixel);
+				const auto right = LoadPixel(row + (x + 1) * BytesPerPixel);
+
+				++samples;
+				runs += pixel == right;
+
+				if(distinct > MaxTextColors)
+					continue;
+
+				const auto key = pixel | 0x01000000;
+				auto index = (key * 0x9E3779B1u) >> 25; // top 7 bits, 128 slots
+				while(colors[index] != 0 && colors[index] != key)
+					index = (index + 1) & (MaxTextColors * 4 - 1);
+
+				if(colors[index] == 0) {
+					colors[index] = key;
+					++distinct;
+				}
+			}
+		}
+
+		if(samples == 0)
+			return true;
+
+		// Photographic content almost never has two equal neighbouring pixels.
+		return distinct <= MaxTextColors || runs * 2 >= samples;
+	}
+
+	Encoder::Encoder()
+		: Encoder(Settings {}) {
+	}
+
+	Encoder::Encoder(Settings settings)
+		: settings_(settings),
+		  codecs_(std::make_unique<Codecs>()) {
+		// zlib only fails to initialize when out of memory.
+		if(deflateInit(&codecs_->zlib, ZlibLevel) != Z_OK)
+			throw std::bad_alloc();
+
+		auto& jpeg = codecs_->jpeg;
+		jpeg.err = jpeg_std_error(&codecs_->jpeg_error.manager);
+		codecs_->jpeg_error.manager.error_exit = &JpegErrorExit;
+		codecs_->jpeg_error.manager.output_message = &JpegOutputMessage;
+		jpeg_create_compress(&jpeg);
+
+		codecs_->jpeg_destination.manager.init_destination = &JpegInitDestination;
+		codecs_->jpeg_destination.manager.empty_output_buffer = &JpegEmptyOutputBuffer;
+		codecs_->jpeg_destination.manager.term_destination = &JpegTermDestination;
+		jpeg.dest = &codecs_->jpeg_destination.manager;
+
+#ifdef LYDIA_HAVE_WEBP
+		// Favour speed over size; these are encoded every frame.
+		WebPConfigPreset(&codecs_->webp_lossy, WEBP_PRESET_DEFAULT, static_cast<float>(settings_.quality));
+		codecs_->webp_lossy.method = 0;
+
+		WebPConfigInit(&codecs_->webp_lossless);
+		WebPConfigLosslessPreset(&codecs_->webp_lossless, 0);
+#endif
+	}
+
+	Encoder::~Encoder() {
+		deflateEnd(&codecs_->zlib);
+		jpeg_destroy_compress(&codecs_->jpeg);
+	}
+
+	Encoder::Encoding Encoder::ChooseEncoding(const FramebufferView& frame, const Rect& rect) const {
+		// Encode() works out whether the WebP should be lossless.
+		if(settings_.legacy && HasWebP())
+			return Encoding::WebP;
+
+		const bool lossless = rect.Area() < MinLossyArea || IsTextLike(frame, rect);
+		return lossless ? Encoding::Zlib : Encoding::Jpeg;
+	}
+
+	void Encoder::Encode(const FramebufferView& frame, const Rect& rect, messages::DisplayRect& out) {
+		Encode(frame, rect, ChooseEncoding(frame, rect), out);
+	}
+
+	void Encoder::Encode(const FramebufferView& frame, const Rect& rect, Encoding encoding, messages::DisplayRect& out) {
+		out.x = static_cast<std::uint16_t>(rect.x);
+		out.y = static_cast<std::uint16_t>(rect.y);
+		out.width = static_cast<std::uint16_t>(rect.width);
+		out.height = static_cast<std::uint16_t>(rect.height);
+
+		auto& data = out.data.GetUnderlying();
+		data.clear();
+
+		bool ok = false;
+		switch(encoding) {
+			case Encoding::Raw:
+				EncodeRaw(frame, rect, data);
+				ok = true;
+				break;
+
+			case Encoding::Jpeg:
+				ok = EncodeJpeg(frame, rect, data);
+				break;
+
+			case Encoding::WebP:
+				ok = EncodeWebP(frame, rect, settings_.lossless_text && (rect.Area() < MinLossyArea || IsTextLike(frame, rect)), data);
+				break;
+
+			default:
+				break;
+		}
+
+		if(!ok) {
+			encoding = Encoding::Zlib;
+			data.clear();
+			EncodeZlib(frame, rect, data);
+		}
+
+		out.encoding = encoding;
+	}
+
+	void Encoder::EncodeRaw(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out) {
+		out.resize(rect.Area() * BytesPerPixel);
+
+		const auto bgrx_to_rgba = narwhal::GetPixelKernels().bgrx_to_rgba;
+		const auto row_bytes = static_cast<std::size_t>(rect.width) * BytesPerPixel;
+
+		auto* dest = out.data();
+		for(auto y = rect.y; y < rect.y + rect.height; ++y, dest += row_bytes)
+			bgrx_to_rgba(frame.Row(y) + rect.x * BytesPerPixel, dest, rect.width);
+	}
+
+	void Encoder::EncodeZlib(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out) {
+		EncodeRaw(frame, rect, rgba_);
+
+		auto& zlib = codecs_->zlib;
+		deflateReset(&zlib);
+
+		out.resize(deflateBound(&zlib, rgba_.size()));
+		zlib.next_in = rgba_.data();
+		zlib.avail_in = static_cast<uInt>(rgba_.size());
+		zlib.next_out = out.data();
+		zlib.avail_out = static_cast<uInt>(out.size());
+
+		// The output buffer is deflateBound() sized, so this always finishes in one call.
+		deflate(&zlib, Z_FINISH);
+		out.resize(zlib.total_out);
+	}
+
+	bool Encoder::EncodeJpeg(const FramebufferView& frame, const Rect& rect, std::vector<std::uint8_t>& out) {
+		auto& jpeg = codecs_->jpeg;
+		auto& rows = codecs_->rows;
+
+		rows.resize(rect.height);
+		codecs_->jpeg_destination.out = &out;
+
+		// Nothing with a destructor may be created past this point;
+		// libjpeg errors longjmp back here.
+		if(setjmp(codecs_->jpeg_error.jump)) {
+			jpeg_abort_compress(&jpeg);
+			return false;
+		}
+
+		jpeg.image_width = rect.width;
+		jpeg.image_height = rect.height;
+
+#ifdef JCS_EXTENSIONS
+		// libjpeg-turbo can read our pixels as they are.
+		jpeg.input_components = 4;
+		jpeg.in_color_space = JCS_EXT_BGRX;
+
+		for(std::uint32_t y = 0; y < rect.height; ++y)
+			rows[y] = const_cast<JSAMPROW>(frame.Row(rect.y + y) + rect.x * BytesPerPixel);
+#else
+		jpeg.input_components = 3;
+		jpeg.in_color_space = JCS_RGB;
+
+		rgba_.resize(rect.Area() * 3);
+		for(std::uint32_t y = 0; y < rect.height; ++y) {
+			const auto* src = frame.Row(rect.y + y) + rect.x * BytesPerPixel;
+			auto* dest = &rgba_[y * rect.width * 3];
+			for(std::uint32_t x = 0; x < rect.width; ++x, src += 4, dest += 3) {
+				dest[0] = src[2];
+				dest[1] = src[1];
+				dest[2] = src[0];
+			}
+			rows[y] = &rgba_[y * rect.width * 3];
+		}
+#endif
+
+		jpeg_set_defaults(&jpeg);
+		jpeg_set_quality(&jpeg, settings_.quality, TRUE);
+		jpeg.dct_method = JDCT_IFAST;
+
+		jpeg_start_compress(&jpeg, TRUE);
+		jpeg_write_scanlines(&jpeg, rows.data(), rect.height);
+		jpeg_finish_compress(&jpeg);
+		return true;
+	}
+
+	bool Encoder::EncodeWebP(const FramebufferView& frame, const Rect& rect, bool lossless, std::vector<std::uint8_t>& out) {
+#ifdef LYDIA_HAVE_WEBP
+		WebPPicture picture;
+		if(!WebPPictureInit(&picture))
+			return false;
+
+		picture.use_argb = lossless;
+		picture.width = static_cast<int>(rect.width);
+		picture.height = static_cast<int>(rect.height);
+		picture.writer = &WebPWriteToVector;
+		picture.custom_ptr = &out;
+
+		bool ok = WebPPictureImportBGRX(&picture, frame.Row(rect.y) + rect.x * BytesPerPixel, static_cast<int>(frame.stride));
+		if(ok)
+			ok = WebPEncode(lossless ? &codecs_->webp_lossless : &codecs_->webp_lossy, &picture);
+
+		WebPPictureFree(&picture);
+		return ok;
+#else
+		static_cast<void>(frame);
+		static_cast<void>(rect);
+		static_cast<void>(lossless);
+		static_cast<void>(out);
+		return false;
+#endif
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,137 @@
+#include <lydia/video/EncoderPool.h>
+
+#include <algorithm>
+
+namespace lydia::video {
+
+	EncoderPool::EncoderPool(std::size_t threads, Encoder::Settings settings, DoneFunction done)
+		: settings_(settings),
+		  done_(std::move(done)) {
+		if(threads == 0)
+			threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+		threads_.reserve(threads);
+		for(std::size_t i = 0; i < threads; ++i)
+			threads_.emplace_back(&EncoderPool::ThreadEntry, this);
+	}
+
+	EncoderPool::~EncoderPool() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		cond_.notify_all();
+
+		for(auto& thread : threads_)
+			thread.join();
+	}
+
+	std::uint64_t EncoderPool::Submit(std::shared_ptr<const Framebuffer> frame, const std::vector<Rect>& rects, const std::vector<messages::CopyRect>& copies) {
+		if(rects.empty() && copies.empty())
+			return 0;
+
+		auto batch = std::make_unique<Batch>();
+		batch->frame = std::move(frame);
+		batch->update.copies.GetUnderlying() = copies;
+
+		std::vector<Job> jobs;
+
+		// Split big rects into full width bands, so they spread over the workers.
+		for(const auto& rect : rects) {
+			if(rect.Area() <= MaxJobArea) {
+				jobs.push_back({ batch.get(), jobs.size(), rect });
+				continue;
+			}
+
+			const auto band = std::max<std::uint32_t>(static_cast<std::uint32_t>(MaxJobArea / rect.width) & ~15u, 16);
+			for(std::uint32_t y = 0; y < rect.height; y += band)
+				jobs.push_back({ batch.get(), jobs.size(), { rect.x, rect.y + y, rect.width, std::min(band, rect.height - y) } });
+		}
+
+		batch->update.rects.GetUnderlying().resize(jobs.size());
+		batch->remaining = jobs.size();
+
+		std::uint64_t sequence;
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			sequence = next_sequence_++;
+			batch->sequence = sequence;
+			batches_.push_back(std::move(batch));
+			jobs_.insert(jobs_.end(), jobs.begin(), jobs.end());
+		}
+
+		// Nothing to encode, so no worker would ever deliver this one.
+		if(jobs.empty())
+			Deliver();
+		else if(jobs.size() == 1)
+			cond_.notify_one();
+		else
+			cond_.notify_all();
+
+		return sequence;
+	}
+
+	std::size_t EncoderPool::Pending() const {
+		std::lock_guard<std::mutex> lock(mutex_);
+		return batches_.size();
+	}
+
+	std::size_t EncoderPool::ThreadCount() const {
+		return threads_.size();
+	}
+
+	void EncoderPool::ThreadEntry() {
+		// Each worker keeps its codec state for its whole life.
+		Encoder encoder(settings_);
+
+		while(true) {
+			Job job;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cond_.wait(lock, [this] {
+					return stopping_ || !jobs_.empty();
+				});
+
+				if(stopping_)
+					return;
+
+				job = jobs_.front();
+				jobs_.pop_front();
+			}
+
+			// Each job writes only its own slot, and the batch can't go away while it has jobs left.
+			const auto view = job.batch->frame->View();
+			encoder.Encode(view, job.rect, job.batch->update.rects.GetUnderlying()[job.index]);
+
+			bool front_done;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				front_done = --job.batch->remaining == 0 && batches_.front().get() == job.batch;
+			}
+
+			// If this finished some frame other than the oldest, whoever finishes the oldest delivers both.
+			if(front_done)
+				Deliver();
+		}
+	}
+
+	void EncoderPool::Deliver() {
+		std::lock_guard<std::mutex> deliver_lock(deliver_mutex_);
+
+		while(true) {
+			std::unique_ptr<Batch> batch;
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				if(batches_.empty() || batches_.front()->remaining != 0)
+					return;
+
+				batch = std::move(batches_.front());
+				batches_.pop_front();
+			}
+
+			if(done_)
+				done_(batch->sequence, batch->update);
+		}
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,214 @@
+#include <lydia/video/ScrollDetector.h>
+#include <narwhal/Hash.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace lydia::video {
+
+	namespace {
+		constexpr std::uint64_t ColumnMultiplier = 0x9e3779b97f4a7c15ull;
+
+		void HashRows(const FramebufferView& frame, const Rect& rect, std::vector<std::uint64_t>& out) {
+			out.resize(rect.height);
+			for(std::uint32_t y = 0; y < rect.height; ++y)
+				out[y] = narwhal::Hash64(frame.Row(rect.y + y) + rect.x * BytesPerPixel, rect.width * BytesPerPixel);
+		}
+
+		void HashColumns(const FramebufferView& frame, const Rect& rect, std::vector<std::uint64_t>& out) {
+			out.assign(rect.width, 0);
+			for(std::uint32_t y = 0; y < rect.height; ++y) {
+				const auto* row = frame.Row(rect.y + y) + rect.x * BytesPerPixel;
+				for(std::uint32_t x = 0; x < rect.width; ++x) {
+					std::uint32_t pixel;
+					std::memcpy(&pixel, row + x * BytesPerPixel, sizeof(pixel));
+					out[x] = (out[x] + pixel) * ColumnMultiplier;
+				}
+			}
+		}
+
+		messages::CopyRect MakeCopy(std::uint32_t src_x, std::uint32_t src_y, std::uint32_t x, std::uint32_t y, std::uint32_t width, std::uint32_t height) {
+			return { static_cast<std::uint16_t>(src_x), static_cast<std::uint16_t>(src_y), static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(y), static_cast<std::uint16_t>(width), static_cast<std::uint16_t>(height) };
+		}
+
+	} // namespace
+
+	void ScrollDetector::Detect(const FramebufferView& previous, const FramebufferView& frame, std::vector<Rect>& rects, std::vector<messages::CopyRect>& copies) {
+		copies.clear();
+
+		if(!previous.data || previous.width != frame.width || previous.height != frame.height)
+			return;
+
+		out_.clear();
+
+		for(const auto& rect : rects) {
+			if(DetectVertical(previous, frame, rect, copies) || DetectHorizontal(previous, frame, rect, copies))
+				continue;
+
+			out_.push_back(rect);
+		}
+
+		rects.swap(out_);
+	}
+
+	bool ScrollDetector::DetectVertical(const FramebufferView& previous, const FramebufferView& frame, const Rect& rect, std::vector<messages::CopyRect>& copies) {
+		if(rect.height < MinSize || rect.width < MinMatch * 2)
+			return false;
+
+		// Dirty rectangles are tile aligned, so the scrolled region rarely covers them edge to edge.
+		// Look for movement in the middle half of the columns, then see how far out it reaches.
+		const Rect window { rect.x + rect.width / 4, rect.y, rect.width / 2, rect.height };
+
+		HashRows(previous, window, before_);
+		HashRows(frame, window, after_);
+
+		Shift shift;
+		if(!FindShift(shift))
+			return false;
+
+		const auto y0 = rect.y + shift.begin;
+		const auto y1 = rect.y + shift.end;
+		const auto src_y = y0 - shift.offset;
+
+		for(auto y = y0; y < y1; ++y) {
+			if(std::memcmp(frame.Row(y) + window.x * BytesPerPixel, previous.Row(src_y + y - y0) + window.x * BytesPerPixel, window.width * BytesPerPixel) != 0)
+				return false;
+		}
+
+		auto x0 = window.x;
+		auto x1 = window.x + window.width;
+		for(auto y = y0; y < y1; ++y) {
+			const auto* now = reinterpret_cast<const std::uint32_t*>(frame.Row(y));
+			const auto* before = reinterpret_cast<const std::uint32_t*>(previous.Row(src_y + y - y0));
+
+			while(x0 > rect.x && now[x0 - 1] == before[x0 - 1])
+				--x0;
+			while(x1 < rect.x + rect.width && now[x1] == before[x1])
+				++x1;
+		}
+
+		// Only as far as every row reaches.
+		for(auto y = y0; y < y1; ++y) {
+			const auto* now = reinterpret_cast<const std::uint32_t*>(frame.Row(y));
+			const auto* before = reinterpret_cast<const std::uint32_t*>(previous.Row(src_y + y - y0));
+
+			for(auto x = x0; x < window.x; ++x) {
+				if(now[x] != before[x])
+					x0 = x + 1;
+			}
+			for(auto x = window.x + window.width; x < x1; ++x) {
+				if(now[x] != before[x]) {
+					x1 = x;
+					break;
+				}
+			}
+		}
+
+		copies.push_back(MakeCopy(x0, src_y, x0, y0, x1 - x0, y1 - y0));
+
+		// What's left: full width above and below the copy, and beside it.
+		if(y0 != rect.y)
+			out_.push_back({ rect.x, rect.y, rect.width, y0 - rect.y });
+		if(x0 != rect.x)
+			out_.push_back({ rect.x, y0, x0 - rect.x, y1 - y0 });
+		if(x1 != rect.x + rect.width)
+			out_.push_back({ x1, y0, rect.x + rect.width - x1, y1 - y0 });
+		if(y1 != rect.y + rect.height)
+			out_.push_back({ rect.x, y1, rect.width, rect.y + rect.height - y1 });
+		return true;
+	}
+
+	bool ScrollDetector::DetectHorizontal(const FramebufferView& previous, const FramebufferView& frame, const Rect& rect, std::vector<messages::CopyRect>& copies) {
+		if(rect.width < MinSize || rect.height < MinMatch * 2)
+			return false;
+
+		// As above, but looking in the middle half of the rows.
+		const Rect window { rect.x, rect.y + rect.height / 4, rect.width, rect.height / 2 };
+
+		HashColumns(previous, window, before_);
+		HashColumns(frame, window, after_);
+
+		Shift shift;
+		if(!FindShift(shift))
+			return false;
+
+		const auto x0 = rect.x + shift.begin;
+		const auto x1 = rect.x + shift.end;
+		const auto src_x = x0 - shift.offset;
+		const auto run_bytes = (x1 - x0) * BytesPerPixel;
+
+		const auto matches = [&](std::uint32_t y) {
+			return std::memcmp(frame.Row(y) + x0 * BytesPerPixel, previous.Row(y) + src_x * BytesPerPixel, run_bytes) == 0;
+		};
+
+		for(auto y = window.y; y < window.y + window.height; ++y) {
+			if(!matches(y))
+				return false;
+		}
+
+		auto y0 = window.y;
+		auto y1 = window.y + window.height;
+		while(y0 > rect.y && matches(y0 - 1))
+			--y0;
+		while(y1 < rect.y + rect.height && matches(y1))
+			++y1;
+
+		copies.push_back(MakeCopy(src_x, y0, x0, y0, x1 - x0, y1 - y0));
+
+		if(x0 != rect.x)
+			out_.push_back({ rect.x, rect.y, x0 - rect.x, rect.height });
+		if(y0 != rect.y)
+			out_.push_back({ x0, rect.y, x1 - x0, y0 - rect.y });
+		if(y1 != rect.y + rect.height)
+			out_.push_back({ x0, y1, x1 - x0, rect.y + rect.height - y1 });
+		if(x1 != rect.x + rect.width)
+			out_.push_back({ x1, rect.y, rect.x + rect.width - x1, rect.height });
+		return true;
+	}
+
+	bool ScrollDetector::FindShift(Shift& shift) {
+		const auto count = static_cast<std::int32_t>(before_.size());
+
+		// Lines with common content (blank lines, mostly) can't tell which way anything moved.
+		lines_.clear();
+		for(std::int32_t i = 0; i < count; ++i) {
+			const auto [it, inserted] = lines_.try_emplace(before_[i], i);
+			if(!inserted)
+				it->second = -1;
+		}
+
+		votes_.assign(static_cast<std::size_t>(count) * 2, 0);
+		for(std::int32_t i = 0; i < count; ++i) {
+			const auto it = lines_.find(after_[i]);
+			if(it != lines_.end() && it->second >= 0 && it->second != i)
+				++votes_[i - it->second + count];
+		}
+
+		const auto best = std::max_element(votes_.begin(), votes_.end());
+		if(*best < MinMatch)
+			return false;
+
+		const auto offset = static_cast<std::int32_t>(best - votes_.begin()) - count;
+
+		// Blank lines in the moved region match too, so take the longest run of matches
+		// rather than just the voting lines.
+		std::uint32_t run_begin = 0;
+		std::uint32_t run_length = 0;
+		shift = { offset, 0, 0 };
+
+		for(auto i = std::max(offset, 0); i < std::min(count, count + offset); ++i) {
+			if(after_[i] != before_[i - offset]) {
+				run_length = 0;
+				continue;
+			}
+
+			if(run_length++ == 0)
+				run_begin = i;
+			if(run_length > shift.end - shift.begin)
+				shift = { offset, run_begin, run_begin + run_length };
+		}
+
+		return shift.end - shift.begin >= MinMatch;
+	}
+
+} // namespace lydia::video
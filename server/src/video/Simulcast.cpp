@@ -0,0 +1,201 @@
+#include <lydia/video/Simulcast.h>
+
+#include <algorithm>
+#include <thread>
+
+namespace lydia::video {
+
+	std::vector<Simulcast::Tier> Simulcast::DefaultTiers() {
+		Tier low;
+		low.framerate = 5;
+		low.quality = 30;
+		low.bitrate = 300;
+		low.max_width = 640;
+		low.max_height = 360;
+
+		Tier medium;
+		medium.framerate = 15;
+		medium.quality = 50;
+		medium.bitrate = 1200;
+		medium.max_width = 1280;
+		medium.max_height = 720;
+		medium.min_throughput = 250'000;
+		medium.max_rtt = std::chrono::milliseconds(400);
+
+		Tier high;
+		high.framerate = 30;
+		high.quality = 75;
+		high.bitrate = 4000;
+		high.min_throughput = 1'000'000;
+		high.max_rtt = std::chrono::milliseconds(150);
+
+		return { low, medium, high };
+	}
+
+	Simulcast::Simulcast(Settings settings, FrameFunction done, VideoCodec::Factory factory)
+		: done_(std::move(done)),
+		  switch_(settings.mode) {
+		auto threads = settings.threads;
+		if(threads == 0)
+			threads = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+
+		const auto count = settings.tiers.size();
+		tiers_.reserve(count);
+
+		for(std::size_t i = 0; i < count; ++i) {
+			auto state = std::make_unique<TierState>();
+			state->tier = settings.tiers[i];
+
+			// Share the threads out, giving any left over to the best tiers, which have the most to encode.
+			const auto pool_threads = std::max<std::size_t>(threads / count + (count - 1 - i < threads % count ? 1 : 0), 1);
+
+			Encoder::Settings encoder_settings;
+			encoder_settings.quality = state->tier.quality;
+			state->pool = std::make_unique<EncoderPool>(pool_threads, encoder_settings, [this, i](std::uint64_t sequence, messages::RectangleUpdateMessage& update) {
+				DeliverRects(i, sequence, update);
+			});
+
+			VideoStream::Settings video_settings;
+			video_settings.bitrate = state->tier.bitrate;
+			video_settings.framerate = state->tier.framerate;
+			video_settings.max_width = state->tier.max_width;
+			video_settings.max_height = state->tier.max_height;
+			state->video = std::make_unique<VideoStream>(video_settings, [this, i](const Buffer& frame, bool keyframe) {
+				if(done_)
+					done_(i, frame, keyframe);
+			}, factory);
+
+			tiers_.push_back(std::move(state));
+		}
+	}
+
+	Simulcast::~Simulcast() {
+		// Stop the encoding threads before anything they call into goes away.
+		for(auto& state : tiers_) {
+			state->pool.reset();
+			state->video.reset();
+		}
+	}
+
+	void Simulcast::Update(const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now) {
+		using Decision = VideoModeSwitch::Decision;
+
+		const bool entering = !switch_.InVideoMode();
+		Decision decision;
+
+		if(VideoFailed()) {
+			// Only the frame after leaving video mode goes through the switch, for its Refresh.
+			decision = Decision::Rects;
+			if(switch_.InVideoMode()) {
+				switch_.Leave();
+				decision = switch_.Update(diff, now);
+			}
+		} else {
+			decision = switch_.Update(diff, now);
+		}
+
+		const bool changed = diff.DirtyTileCount() != 0;
+
+		for(auto& state : tiers_) {
+			if(decision == Decision::Video) {
+				const bool sync = state->sync_requested.exchange(false, std::memory_order_acq_rel);
+				state->video->Submit(frame, changed, entering || sync, now);
+			} else {
+				UpdateRects(*state, frame, diff, decision == Decision::Refresh, now);
+			}
+		}
+	}
+
+	void Simulcast::RequestSync(std::size_t tier) {
+		if(tier < tiers_.size())
+			tiers_[tier]->sync_requested.store(true, std::memory_order_release);
+	}
+
+	std::size_t Simulcast::TierCount() const {
+		return tiers_.size();
+	}
+
+	const Simulcast::Tier& Simulcast::GetTier(std::size_t tier) const {
+		return tiers_[tier]->tier;
+	}
+
+	bool Simulcast::InVideoMode() const {
+		return switch_.InVideoMode();
+	}
+
+	void Simulcast::UpdateRects(TierState& state, const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, bool refresh, Clock::time_point now) {
+		const auto& dirty = diff.DirtyTiles();
+
+		// A different tile count means a resize, after which the whole frame goes out.
+		if(state.dirty.size() != dirty.size()) {
+			state.dirty.assign(dirty.size(), 0);
+			refresh = true;
+		} else {
+			for(std::size_t i = 0; i < dirty.size(); ++i)
+				state.dirty[i] |= dirty[i];
+		}
+
+		const bool sync = refresh || state.sync_requested.exchange(false, std::memory_order_acq_rel);
+		const auto interval = std::chrono::milliseconds(1000) / std::max<std::uint32_t>(state.tier.framerate, 1);
+
+		if(!sync) {
+			if(now - state.last_submit < interval)
+				return;
+			if(std::none_of(state.dirty.begin(), state.dirty.end(), [](std::uint8_t tile) { return tile != 0; }))
+				return;
+		}
+
+		if(sync) {
+			rects_.assign(1, { 0, 0, frame->width, frame->height });
+			if(frame->width == 0 || frame->height == 0)
+				rects_.clear();
+		} else {
+			diff.MergeTiles(state.dirty, rects_);
+		}
+
+		std::fill(state.dirty.begin(), state.dirty.end(), 0);
+		state.last_submit = now;
+
+		if(!sync) {
+			state.pool->Submit(frame, rects_);
+			return;
+		}
+
+		std::lock_guard<std::mutex> lock(state.sync_mutex);
+		const auto sequence = state.pool->Submit(frame, rects_);
+		if(sequence != 0)
+			state.sync_sequences.push_back(sequence);
+	}
+
+	void Simulcast::DeliverRects(std::size_t tier, std::uint64_t sequence, const messages::RectangleUpdateMessage& update) {
+		auto& state = *tiers_[tier];
+
+		bool sync = false;
+		{
+			std::lock_guard<std::mutex> lock(state.sync_mutex);
+			const auto it = std::find(state.sync_sequences.begin(), state.sync_sequences.end(), sequence);
+			if(it != state.sync_sequences.end()) {
+				state.sync_sequences.erase(it);
+				sync = true;
+			}
+		}
+
+		std::size_t size = 16;
+		for(const auto& rect : update.rects.GetUnderlying())
+			size += rect.data.GetUnderlying().size() + 16;
+
+		binproto::BufferWriter writer(size);
+		update.header.Write(writer);
+		update.WritePayload(writer);
+
+		if(done_)
+			done_(tier, std::make_shared<const std::vector<std::uint8_t>>(writer.Release()), sync);
+	}
+
+	bool Simulcast::VideoFailed() const {
+		return std::any_of(tiers_.begin(), tiers_.end(), [](const auto& state) {
+			return state->video->Failed();
+		});
+	}
+
+} // namespace lydia::video
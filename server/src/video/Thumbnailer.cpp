@@ -0,0 +1,161 @@
+#include <lydia/video/Downsample.h>
+#include <lydia/video/Encoder.h>
+#include <lydia/video/Thumbnailer.h>
+
+#include <algorithm>
+
+#ifdef __linux__
+	#include <pthread.h>
+	#include <sched.h>
+#endif
+
+namespace lydia::video {
+
+	Thumbnail::Bytes Thumbnail::Get() const {
+		return bytes_.load(std::memory_order_acquire);
+	}
+
+	std::uint64_t Thumbnail::GetVersion() const {
+		return version_.load(std::memory_order_acquire);
+	}
+
+	Thumbnailer::Thumbnailer()
+		: Thumbnailer(Settings {}) {
+	}
+
+	Thumbnailer::Thumbnailer(Settings settings)
+		: settings_(settings),
+		  thread_(&Thumbnailer::ThreadEntry, this) {
+	}
+
+	Thumbnailer::~Thumbnailer() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		cond_.notify_one();
+		thread_.join();
+	}
+
+	std::shared_ptr<Thumbnail> Thumbnailer::Create() const {
+		return std::make_shared<Thumbnail>();
+	}
+
+	bool Thumbnailer::Update(const std::shared_ptr<Thumbnail>& thumbnail, const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now) {
+		auto& changed = thumbnail->changed_;
+		const auto& dirty = diff.DirtyTiles();
+
+		// A different tile count means a resize, which always counts as a full change.
+		if(changed.size() != dirty.size()) {
+			changed.assign(dirty.size(), 1);
+			thumbnail->changed_count_ = dirty.size();
+		} else if(diff.DirtyTileCount() != 0) {
+			for(std::size_t i = 0; i < dirty.size(); ++i) {
+				thumbnail->changed_count_ += dirty[i] & ~changed[i] & 1;
+				changed[i] |= dirty[i];
+			}
+		}
+
+		const bool first = thumbnail->GetVersion() == 0 && thumbnail->last_queued_ == Clock::time_point {};
+		if(!first) {
+			if(static_cast<double>(thumbnail->changed_count_) < settings_.min_change * static_cast<double>(changed.size()))
+				return false;
+			if(now - thumbnail->last_queued_ < settings_.min_interval)
+				return false;
+		}
+
+		std::fill(changed.begin(), changed.end(), 0);
+		thumbnail->changed_count_ = 0;
+		thumbnail->last_queued_ = now;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			thumbnail->pending_ = frame;
+			if(thumbnail->queued_)
+				return true;
+
+			thumbnail->queued_ = true;
+			queue_.push_back(thumbnail);
+		}
+		cond_.notify_one();
+		return true;
+	}
+
+	bool Thumbnailer::Available() {
+		return Encoder::HasWebP();
+	}
+
+	void Thumbnailer::ThreadEntry() {
+#ifdef __linux__
+		// Previews can wait; anything else the server has to do can't.
+		sched_param param {};
+		pthread_setschedparam(pthread_self(), SCHED_IDLE, &param);
+#endif
+
+		Encoder::Settings encoder_settings;
+		encoder_settings.quality = settings_.quality;
+		encoder_settings.lossless_text = false;
+		Encoder encoder(encoder_settings);
+
+		Framebuffer scaled;
+		messages::DisplayRect encoded;
+
+		while(true) {
+			std::shared_ptr<Thumbnail> thumbnail;
+			std::shared_ptr<const Framebuffer> frame;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cond_.wait(lock, [this] {
+					return stopping_ || !queue_.empty();
+				});
+
+				if(stopping_)
+					return;
+
+				thumbnail = queue_.front().lock();
+				queue_.pop_front();
+				if(!thumbnail)
+					continue;
+
+				thumbnail->queued_ = false;
+				frame = std::move(thumbnail->pending_);
+			}
+
+			if(!frame || !Available())
+				continue;
+
+			Scale(frame->View(), scaled);
+			frame.reset();
+
+			encoder.Encode(scaled.View(), { 0, 0, Size, Size }, Encoder::Encoding::WebP, encoded);
+			if(encoded.encoding != Encoder::Encoding::WebP)
+				continue;
+
+			thumbnail->bytes_.store(std::make_shared<const std::vector<std::uint8_t>>(std::move(encoded.data.GetUnderlying())), std::memory_order_release);
+			thumbnail->version_.fetch_add(1, std::memory_order_acq_rel);
+		}
+	}
+
+	void Thumbnailer::Scale(const FramebufferView& frame, Framebuffer& out) {
+		out.width = Size;
+		out.height = Size;
+		out.stride = Size * BytesPerPixel;
+		out.data.assign(out.stride * Size, 0);
+
+		if(frame.width == 0 || frame.height == 0)
+			return;
+
+		// Fit the longer side, keeping the aspect ratio.
+		std::uint32_t width = Size;
+		std::uint32_t height = Size;
+		if(frame.width >= frame.height)
+			height = std::max<std::uint32_t>(static_cast<std::uint32_t>(static_cast<std::uint64_t>(frame.height) * Size / frame.width), 1);
+		else
+			width = std::max<std::uint32_t>(static_cast<std::uint32_t>(static_cast<std::uint64_t>(frame.width) * Size / frame.height), 1);
+
+		const auto x = (Size - width) / 2;
+		const auto y = (Size - height) / 2;
+		Downsample(frame, out.data.data() + y * out.stride + x * BytesPerPixel, width, height, out.stride);
+	}
+
+} // namespace lydia::video
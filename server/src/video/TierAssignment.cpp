@@ -0,0 +1,136 @@
+#include <lydia/video/TierAssignment.h>
+
+#include <algorithm>
+
+namespace lydia::video {
+
+	namespace {
+		void Erase(std::vector<std::uint64_t>& list, std::uint64_t cid) {
+			const auto it = std::find(list.begin(), list.end(), cid);
+			if(it == list.end())
+				return;
+
+			// Order doesn't matter.
+			*it = list.back();
+			list.pop_back();
+		}
+	} // namespace
+
+	TierAssignment::TierAssignment(std::vector<Simulcast::Tier> tiers, SyncFunction sync)
+		: TierAssignment(std::move(tiers), Settings {}, std::move(sync)) {
+	}
+
+	TierAssignment::TierAssignment(std::vector<Simulcast::Tier> tiers, Settings settings, SyncFunction sync)
+		: tiers_(std::move(tiers)),
+		  settings_(settings),
+		  sync_(std::move(sync)),
+		  members_(tiers_.size()) {
+	}
+
+	void TierAssignment::Add(std::uint64_t cid, double throughput, std::chrono::microseconds rtt) {
+		if(tiers_.empty() || viewers_.contains(cid))
+			return;
+
+		auto& viewer = viewers_[cid];
+		Retarget(viewer, Choose(throughput, rtt, 0));
+	}
+
+	void TierAssignment::Update(std::uint64_t cid, double throughput, std::chrono::microseconds rtt, Clock::time_point now) {
+		const auto it = viewers_.find(cid);
+		if(it == viewers_.end())
+			return;
+
+		auto& viewer = it->second;
+		const auto current = viewer.tier != None ? viewer.tier : viewer.target;
+		const auto chosen = Choose(throughput, rtt, current);
+
+		// Moving down (or staying, which calls off any move) happens right away.
+		if(chosen <= current) {
+			viewer.upgradable = {};
+			Retarget(viewer, chosen);
+			return;
+		}
+
+		if(viewer.upgradable == Clock::time_point {})
+			viewer.upgradable = now;
+
+		if(now - viewer.upgradable >= settings_.upgrade_after)
+			Retarget(viewer, chosen);
+	}
+
+	void TierAssignment::Remove(std::uint64_t cid) {
+		const auto it = viewers_.find(cid);
+		if(it == viewers_.end())
+			return;
+
+		if(it->second.tier != None)
+			Erase(members_[it->second.tier], cid);
+		viewers_.erase(it);
+	}
+
+	const std::vector<std::uint64_t>& TierAssignment::Route(std::size_t tier, bool sync) {
+		if(sync) {
+			for(auto& [cid, viewer] : viewers_) {
+				if(viewer.target != tier)
+					continue;
+
+				if(viewer.tier != None)
+					Erase(members_[viewer.tier], cid);
+
+				viewer.tier = tier;
+				viewer.target = None;
+				members_[tier].push_back(cid);
+			}
+		}
+
+		return members_[tier];
+	}
+
+	std::optional<std::size_t> TierAssignment::GetTier(std::uint64_t cid) const {
+		const auto it = viewers_.find(cid);
+		if(it == viewers_.end() || it->second.tier == None)
+			return std::nullopt;
+		return it->second.tier;
+	}
+
+	std::optional<std::size_t> TierAssignment::GetTarget(std::uint64_t cid) const {
+		const auto it = viewers_.find(cid);
+		if(it == viewers_.end() || it->second.target == None)
+			return std::nullopt;
+		return it->second.target;
+	}
+
+	std::size_t TierAssignment::Choose(double throughput, std::chrono::microseconds rtt, std::size_t current) const {
+		// The worst tier is for anyone.
+		std::size_t chosen = 0;
+
+		for(std::size_t i = 1; i < tiers_.size(); ++i) {
+			const auto& tier = tiers_[i];
+			const auto needed = i > current ? tier.min_throughput * settings_.headroom : tier.min_throughput;
+
+			if(throughput < needed)
+				break;
+			if(tier.max_rtt.count() != 0 && rtt > tier.max_rtt)
+				break;
+
+			chosen = i;
+		}
+
+		return chosen;
+	}
+
+	void TierAssignment::Retarget(Viewer& viewer, std::size_t tier) {
+		if(tier == viewer.tier) {
+			viewer.target = None;
+			return;
+		}
+
+		if(tier == viewer.target)
+			return;
+
+		viewer.target = tier;
+		if(sync_)
+			sync_(tier);
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,120 @@
+#include <lydia/video/TileCache.h>
+
+#include <algorithm>
+
+namespace lydia::video {
+
+	TileCache::TileCache(std::uint32_t capacity)
+		: slots_(std::max<std::uint32_t>(capacity, 1)) {
+		keys_.reserve(slots_.size());
+	}
+
+	void TileCache::Plan(const TileDiff& diff, std::vector<std::uint8_t>& needed, messages::TileCacheMessage& message) {
+		auto& draws = message.draws.GetUnderlying();
+		auto& stores = message.stores.GetUnderlying();
+		draws.clear();
+		stores.clear();
+
+		const auto& dirty = diff.DirtyTiles();
+		const auto& hashes = diff.TileHashes();
+		++frame_;
+
+		for(std::size_t i = 0; i < dirty.size(); ++i) {
+			if(!dirty[i])
+				continue;
+
+			const auto rect = diff.TileRect(i);
+			const messages::CachedTile tile { 0, static_cast<std::uint16_t>(rect.x), static_cast<std::uint16_t>(rect.y), static_cast<std::uint16_t>(rect.width), static_cast<std::uint16_t>(rect.height) };
+
+			// Edge tiles are hashed zero padded, so the size has to be part of the key:
+			// a cut short tile drawn at a full size spot would leave part of it stale.
+			const auto key = hashes[i] ^ ((static_cast<std::uint64_t>(rect.width) << 16 | rect.height) * 0x9e3779b97f4a7c15ull);
+
+			const auto it = keys_.find(key);
+
+			// Slots stored this frame don't hold anything until after the draws, so those are misses.
+			if(it != keys_.end() && slots_[it->second].stored != frame_) {
+				Touch(it->second);
+				draws.push_back(tile);
+				draws.back().slot = it->second;
+				continue;
+			}
+
+			needed[i] = 1;
+			if(it != keys_.end())
+				continue;
+
+			const auto slot = Allocate(key);
+			slots_[slot].stored = frame_;
+			stores.push_back(tile);
+			stores.back().slot = slot;
+		}
+	}
+
+	void TileCache::Clear() {
+		for(auto& slot : slots_)
+			slot = {};
+
+		keys_.clear();
+		head_ = tail_ = None;
+		unused_ = 0;
+	}
+
+	std::uint32_t TileCache::Capacity() const {
+		return static_cast<std::uint32_t>(slots_.size());
+	}
+
+	std::size_t TileCache::Size() const {
+		return keys_.size();
+	}
+
+	void TileCache::Touch(std::uint32_t slot) {
+		if(head_ == slot)
+			return;
+
+		Unlink(slot);
+
+		auto& s = slots_[slot];
+		s.prev = None;
+		s.next = head_;
+		if(head_ != None)
+			slots_[head_].prev = slot;
+		head_ = slot;
+		if(tail_ == None)
+			tail_ = slot;
+	}
+
+	void TileCache::Unlink(std::uint32_t slot) {
+		auto& s = slots_[slot];
+
+		if(s.prev != None)
+			slots_[s.prev].next = s.next;
+		else if(head_ == slot)
+			head_ = s.next;
+
+		if(s.next != None)
+			slots_[s.next].prev = s.prev;
+		else if(tail_ == slot)
+			tail_ = s.prev;
+
+		s.prev = s.next = None;
+	}
+
+	std::uint32_t TileCache::Allocate(std::uint64_t key) {
+		std::uint32_t slot;
+		if(unused_ < slots_.size()) {
+			slot = unused_++;
+		} else {
+			slot = tail_;
+			keys_.erase(slots_[slot].key);
+		}
+
+		auto& s = slots_[slot];
+		s.key = key;
+		keys_[key] = slot;
+
+		Touch(slot);
+		return slot;
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,285 @@
+#include <lydia/video/TileDiff.h>
+#include <narwhal/Hash.h>
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+	#include <immintrin.h>
+	#define LYDIA_TILEDIFF_X86
+#endif
+
+namespace lydia::video {
+
+	namespace {
+		constexpr std::size_t StripeBytes = 64;
+		constexpr std::uint32_t MaxTileSize = 64;
+
+		constexpr std::uint64_t KeySeed = 0x4c79646961546964ull;
+		constexpr std::uint64_t FinishSeed = 0x54696c6548617368ull;
+
+		std::uint64_t SplitMix64(std::uint64_t& state) {
+			auto z = (state += 0x9e3779b97f4a7c15ull);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+			return z ^ (z >> 31);
+		}
+
+		void AccumulateRowScalar(const std::uint8_t* row, const std::uint64_t* keys, std::size_t stripes, std::size_t tiles, std::uint64_t* accumulators) {
+			for(std::size_t t = 0; t < tiles; ++t) {
+				auto* acc = accumulators + t * 8;
+				const auto* p = row + t * stripes * StripeBytes;
+
+				for(std::size_t s = 0; s < stripes; ++s) {
+					for(std::size_t i = 0; i < 8; ++i) {
+						std::uint64_t data;
+						std::memcpy(&data, p + s * StripeBytes + i * 8, sizeof(data));
+
+						const auto keyed = data ^ keys[s * 8 + i];
+						acc[i ^ 1] += data;
+						acc[i] += (keyed & 0xFFFFFFFF) * (keyed >> 32);
+					}
+				}
+			}
+		}
+
+#ifdef LYDIA_TILEDIFF_X86
+		__attribute__((target("sse2"))) void AccumulateRowSse2(const std::uint8_t* row, const std::uint64_t* keys, std::size_t stripes, std::size_t tiles, std::uint64_t* accumulators) {
+			for(std::size_t t = 0; t < tiles; ++t) {
+				auto* acc = reinterpret_cast<__m128i*>(accumulators + t * 8);
+				const auto* p = row + t * stripes * StripeBytes;
+
+				__m128i a[4];
+				for(int i = 0; i < 4; ++i)
+					a[i] = _mm_load_si128(acc + i);
+
+				for(std::size_t s = 0; s < stripes; ++s) {
+					for(int i = 0; i < 4; ++i) {
+						const auto data = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + s * StripeBytes + i * 16));
+						const auto keyed = _mm_xor_si128(data, _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + s * 8 + i * 2)));
+						const auto product = _mm_mul_epu32(keyed, _mm_srli_epi64(keyed, 32));
+						a[i] = _mm_add_epi64(a[i], _mm_add_epi64(product, _mm_shuffle_epi32(data, _MM_SHUFFLE(1, 0, 3, 2))));
+					}
+				}
+
+				for(int i = 0; i < 4; ++i)
+					_mm_store_si128(acc + i, a[i]);
+			}
+		}
+
+		__attribute__((target("avx2"))) void AccumulateRowAvx2(const std::uint8_t* row, const std::uint64_t* keys, std::size_t stripes, std::size_t tiles, std::uint64_t* accumulators) {
+			for(std::size_t t = 0; t < tiles; ++t) {
+				auto* acc = reinterpret_cast<__m256i*>(accumulators + t * 8);
+				const auto* p = row + t * stripes * StripeBytes;
+
+				auto a0 = _mm256_load_si256(acc);
+				auto a1 = _mm256_load_si256(acc + 1);
+
+				for(std::size_t s = 0; s < stripes; ++s) {
+					const auto d0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + s * StripeBytes));
+					const auto d1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + s * StripeBytes + 32));
+					const auto k0 = _mm256_xor_si256(d0, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + s * 8)));
+					const auto k1 = _mm256_xor_si256(d1, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + s * 8 + 4)));
+
+					// lo32 * hi32 of each keyed lane, plus the unkeyed lane swapped with its neighbour.
+					const auto m0 = _mm256_mul_epu32(k0, _mm256_srli_epi64(k0, 32));
+					const auto m1 = _mm256_mul_epu32(k1, _mm256_srli_epi64(k1, 32));
+					a0 = _mm256_add_epi64(a0, _mm256_add_epi64(m0, _mm256_shuffle_epi32(d0, _MM_SHUFFLE(1, 0, 3, 2))));
+					a1 = _mm256_add_epi64(a1, _mm256_add_epi64(m1, _mm256_shuffle_epi32(d1, _MM_SHUFFLE(1, 0, 3, 2))));
+				}
+
+				_mm256_store_si256(acc, a0);
+				_mm256_store_si256(acc + 1, a1);
+			}
+		}
+#endif
+
+	} // namespace
+
+	TileDiff::TileDiff(std::uint32_t tile_size)
+		: tile_size_(std::clamp<std::uint32_t>((tile_size + 15) & ~15u, 16, MaxTileSize)),
+		  kernel_(&AccumulateRowScalar),
+		  kernel_name_("scalar") {
+#ifdef LYDIA_TILEDIFF_X86
+		__builtin_cpu_init();
+		if(__builtin_cpu_supports("avx2")) {
+			kernel_ = &AccumulateRowAvx2;
+			kernel_name_ = "avx2";
+		} else if(__builtin_cpu_supports("sse2")) {
+			kernel_ = &AccumulateRowSse2;
+			kernel_name_ = "sse2";
+		}
+#endif
+
+		// Every stripe of a tile gets its own key, so moving content around
+		// inside a tile (which the accumulator sums alone wouldn't notice) changes its hash.
+		const auto stripes = tile_size_ * BytesPerPixel / StripeBytes;
+		keys_.resize(tile_size_ * stripes * 8);
+
+		auto state = KeySeed;
+		for(auto& key : keys_)
+			key = SplitMix64(state);
+	}
+
+	const std::vector<Rect>& TileDiff::Diff(const FramebufferView& frame) {
+		rects_.clear();
+
+		if(frame.width == 0 || frame.height == 0) {
+			valid_ = false;
+			dirty_count_ = 0;
+			return rects_;
+		}
+
+		const bool full = !valid_ || frame.width != width_ || frame.height != height_;
+		if(full)
+			Resize(frame);
+
+		const auto stripes = tile_size_ * BytesPerPixel / StripeBytes;
+		const auto tile_bytes = static_cast<std::size_t>(tile_size_) * BytesPerPixel;
+		const auto full_columns = width_ / tile_size_;
+		const auto tail_bytes = (width_ % tile_size_) * BytesPerPixel;
+
+		dirty_count_ = 0;
+
+		for(std::uint32_t ty = 0; ty < rows_; ++ty) {
+			const auto y0 = ty * tile_size_;
+			const auto y1 = std::min(y0 + tile_size_, height_);
+
+			std::memset(accumulators_.data(), 0, accumulators_.size() * sizeof(Accumulator));
+			auto* accumulators = accumulators_.front().lanes;
+
+			for(auto y = y0; y < y1; ++y) {
+				const auto* row = frame.Row(y);
+				const auto* keys = &keys_[(y - y0) * stripes * 8];
+
+				kernel_(row, keys, stripes, full_columns, accumulators);
+
+				if(tail_bytes != 0) {
+					std::memcpy(tail_.data(), row + full_columns * tile_bytes, tail_bytes);
+					kernel_(tail_.data(), keys, stripes, 1, accumulators + full_columns * 8);
+				}
+			}
+
+			for(std::uint32_t tx = 0; tx < columns_; ++tx) {
+				const auto index = static_cast<std::size_t>(ty) * columns_ + tx;
+				const auto hash = narwhal::Hash64(accumulators_[tx].lanes, sizeof(Accumulator::lanes), FinishSeed);
+
+				const bool dirty = full || hashes_[index] != hash;
+				hashes_[index] = hash;
+				tiles_[index] = dirty;
+				dirty_count_ += dirty;
+			}
+		}
+
+		valid_ = true;
+
+		if(full)
+			rects_.push_back({ 0, 0, width_, height_ });
+		else
+			MergeTiles(tiles_, rects_);
+
+		return rects_;
+	}
+
+	void TileDiff::Reset() {
+		valid_ = false;
+	}
+
+	std::uint32_t TileDiff::GetTileSize() const {
+		return tile_size_;
+	}
+
+	std::size_t TileDiff::TileCount() const {
+		return tiles_.size();
+	}
+
+	std::size_t TileDiff::DirtyTileCount() const {
+		return dirty_count_;
+	}
+
+	const std::vector<std::uint8_t>& TileDiff::DirtyTiles() const {
+		return tiles_;
+	}
+
+	const std::vector<std::uint64_t>& TileDiff::TileHashes() const {
+		return hashes_;
+	}
+
+	Rect TileDiff::TileRect(std::size_t index) const {
+		const auto x = static_cast<std::uint32_t>(index % columns_) * tile_size_;
+		const auto y = static_cast<std::uint32_t>(index / columns_) * tile_size_;
+		return { x, y, std::min(tile_size_, width_ - x), std::min(tile_size_, height_ - y) };
+	}
+
+	const char* TileDiff::KernelName() const {
+		return kernel_name_;
+	}
+
+	void TileDiff::Resize(const FramebufferView& frame) {
+		width_ = frame.width;
+		height_ = frame.height;
+
+		columns_ = (width_ + tile_size_ - 1) / tile_size_;
+		rows_ = (height_ + tile_size_ - 1) / tile_size_;
+
+		hashes_.assign(static_cast<std::size_t>(columns_) * rows_, 0);
+		tiles_.assign(static_cast<std::size_t>(columns_) * rows_, 0);
+		accumulators_.resize(columns_);
+
+		// The part of the tail tile past the frame edge stays zero.
+		tail_.assign(static_cast<std::size_t>(tile_size_) * BytesPerPixel, 0);
+	}
+
+	void TileDiff::MergeTiles(const std::vector<std::uint8_t>& tiles, std::vector<Rect>& rects) const {
+		rects.clear();
+
+		struct Run {
+			std::uint32_t begin;
+			std::uint32_t end;
+			std::size_t rect;
+		};
+
+		// Runs of the tile row above, which rects in this row may extend.
+		std::vector<Run> above;
+		std::vector<Run> current;
+
+		for(std::uint32_t ty = 0; ty < rows_; ++ty) {
+			const auto* dirty = &tiles[static_cast<std::size_t>(ty) * columns_];
+			const auto y0 = ty * tile_size_;
+			const auto height = std::min(tile_size_, height_ - y0);
+
+			current.clear();
+			auto it = above.begin();
+
+			for(std::uint32_t tx = 0; tx < columns_;) {
+				if(!dirty[tx]) {
+					++tx;
+					continue;
+				}
+
+				auto end = tx;
+				while(end < columns_ && dirty[end])
+					++end;
+
+				// Both run lists are sorted, so walk them together.
+				while(it != above.end() && it->end <= tx)
+					++it;
+
+				if(it != above.end() && it->begin == tx && it->end == end) {
+					rects[it->rect].height += height;
+					current.push_back({ tx, end, it->rect });
+				} else {
+					const auto x0 = tx * tile_size_;
+					const auto x1 = std::min(end * tile_size_, width_);
+					rects.push_back({ x0, y0, x1 - x0, height });
+					current.push_back({ tx, end, rects.size() - 1 });
+				}
+
+				tx = end;
+			}
+
+			std::swap(above, current);
+		}
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,130 @@
+#include <lydia/video/VideoCodec.h>
+
+#include <algorithm>
+
+#ifdef LYDIA_HAVE_VPX
+	#include <vpx/vp8cx.h>
+	#include <vpx/vpx_encoder.h>
+#endif
+
+namespace lydia::video {
+
+	namespace {
+#ifdef LYDIA_HAVE_VPX
+		/**
+		 * VP8 through libvpx, set up for realtime screen content: one pass, no lookahead,
+		 * and the fastest speed setting, so a frame is out as soon as it's encoded.
+		 */
+		struct Vp8Codec : VideoCodec {
+			/**
+			 * libvpx speed setting; -16 is the fastest realtime one.
+			 */
+			constexpr static int Speed = -16;
+
+			~Vp8Codec() override {
+				if(initialized_)
+					vpx_codec_destroy(&codec_);
+			}
+
+			bool Init(const Settings& settings) {
+				vpx_codec_enc_cfg_t config {};
+				if(vpx_codec_enc_config_default(vpx_codec_vp8_cx(), &config, 0) != VPX_CODEC_OK)
+					return false;
+
+				config.g_w = settings.width;
+				config.g_h = settings.height;
+				config.g_timebase = { 1, 1000 };
+				config.g_threads = 1;
+				config.g_lag_in_frames = 0;
+				config.g_error_resilient = VPX_ERROR_RESILIENT_DEFAULT;
+				config.rc_end_usage = VPX_CBR;
+				config.rc_target_bitrate = settings.bitrate;
+				config.rc_dropframe_thresh = 30;
+				config.rc_min_quantizer = 4;
+				config.rc_max_quantizer = 56;
+				config.rc_buf_sz = 1000;
+				config.rc_buf_initial_sz = 500;
+				config.rc_buf_optimal_sz = 600;
+
+				// VideoStream decides when keyframes happen.
+				config.kf_mode = VPX_KF_DISABLED;
+
+				if(vpx_codec_enc_init(&codec_, vpx_codec_vp8_cx(), &config, 0) != VPX_CODEC_OK)
+					return false;
+				initialized_ = true;
+
+				vpx_codec_control(&codec_, VP8E_SET_CPUUSED, Speed);
+				vpx_codec_control(&codec_, VP8E_SET_STATIC_THRESHOLD, 1);
+				vpx_codec_control(&codec_, VP8E_SET_SCREEN_CONTENT_MODE, 1);
+
+				width_ = settings.width;
+				height_ = settings.height;
+				frame_duration_ = 1000 / std::max<std::uint32_t>(settings.framerate, 1);
+				return true;
+			}
+
+			Codec GetCodec() const override {
+				return Codec::VP8;
+			}
+
+			bool Encode(const narwhal::I420Planes& frame, std::uint32_t timestamp, bool keyframe, std::vector<std::uint8_t>& out, bool& is_keyframe) override {
+				out.clear();
+				is_keyframe = false;
+
+				vpx_image_t image {};
+				vpx_img_wrap(&image, VPX_IMG_FMT_I420, width_, height_, 1, frame.y);
+				image.planes[VPX_PLANE_Y] = frame.y;
+				image.planes[VPX_PLANE_U] = frame.u;
+				image.planes[VPX_PLANE_V] = frame.v;
+				image.stride[VPX_PLANE_Y] = static_cast<int>(frame.y_stride);
+				image.stride[VPX_PLANE_U] = static_cast<int>(frame.u_stride);
+				image.stride[VPX_PLANE_V] = static_cast<int>(frame.v_stride);
+
+				const vpx_enc_frame_flags_t flags = keyframe ? VPX_EFLAG_FORCE_KF : 0;
+				if(vpx_codec_encode(&codec_, &image, timestamp, frame_duration_, flags, VPX_DL_REALTIME) != VPX_CODEC_OK)
+					return false;
+
+				vpx_codec_iter_t iterator = nullptr;
+				while(const auto* packet = vpx_codec_get_cx_data(&codec_, &iterator)) {
+					if(packet->kind != VPX_CODEC_CX_FRAME_PKT)
+						continue;
+
+					const auto* data = static_cast<const std::uint8_t*>(packet->data.frame.buf);
+					out.insert(out.end(), data, data + packet->data.frame.sz);
+					is_keyframe = (packet->data.frame.flags & VPX_FRAME_IS_KEY) != 0;
+				}
+
+				return true;
+			}
+
+		   private:
+			vpx_codec_ctx_t codec_ {};
+			bool initialized_ {};
+
+			std::uint32_t width_ {};
+			std::uint32_t height_ {};
+			unsigned long frame_duration_ {};
+		};
+#endif
+	} // namespace
+
+	std::unique_ptr<VideoCodec> VideoCodec::Create(const Settings& settings) {
+#ifdef LYDIA_HAVE_VPX
+		auto codec = std::make_unique<Vp8Codec>();
+		if(codec->Init(settings))
+			return codec;
+#else
+		static_cast<void>(settings);
+#endif
+		return nullptr;
+	}
+
+	bool VideoCodec::Available() {
+#ifdef LYDIA_HAVE_VPX
+		return true;
+#else
+		return false;
+#endif
+	}
+
+} // namespace lydia::video
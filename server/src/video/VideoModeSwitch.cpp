@@ -0,0 +1,73 @@
+#include <lydia/video/VideoModeSwitch.h>
+
+#include <algorithm>
+
+namespace lydia::video {
+
+	VideoModeSwitch::VideoModeSwitch()
+		: VideoModeSwitch(Settings {}) {
+	}
+
+	VideoModeSwitch::VideoModeSwitch(Settings settings)
+		: settings_(settings) {
+	}
+
+	VideoModeSwitch::Decision VideoModeSwitch::Update(const TileDiff& diff, Clock::time_point now) {
+		const auto tiles = diff.TileCount();
+		const auto change = tiles != 0 ? static_cast<double>(diff.DirtyTileCount()) / static_cast<double>(tiles) : 0.0;
+
+		// Weigh the frame by how long it stood, so the rate doesn't depend on the capture rate.
+		if(last_update_ != Clock::time_point {}) {
+			const auto elapsed = std::chrono::duration<double>(now - last_update_).count();
+			const auto smoothing = std::chrono::duration<double>(settings_.smoothing).count();
+			const auto weight = smoothing > 0.0 ? std::min(elapsed / smoothing, 1.0) : 1.0;
+			rate_ += (change - rate_) * weight;
+		}
+		last_update_ = now;
+
+		const bool crossing = video_ ? rate_ < settings_.leave_change : rate_ >= settings_.enter_change;
+		if(!crossing) {
+			crossed_ = {};
+		} else {
+			if(crossed_ == Clock::time_point {})
+				crossed_ = now;
+
+			if(now - crossed_ >= (video_ ? settings_.leave_after : settings_.enter_after)) {
+				video_ = !video_;
+				refresh_ = !video_;
+				crossed_ = {};
+			}
+		}
+
+		if(video_)
+			return Decision::Video;
+
+		if(refresh_) {
+			refresh_ = false;
+			return Decision::Refresh;
+		}
+
+		return Decision::Rects;
+	}
+
+	void VideoModeSwitch::Leave() {
+		if(!video_)
+			return;
+
+		video_ = false;
+		refresh_ = true;
+		crossed_ = {};
+
+		// Start over, so it takes a new burst of changes to come back.
+		rate_ = 0.0;
+	}
+
+	bool VideoModeSwitch::InVideoMode() const {
+		return video_;
+	}
+
+	double VideoModeSwitch::GetChangeRate() const {
+		return rate_;
+	}
+
+} // namespace lydia::video
@@ -0,0 +1,195 @@
+#include <lydia/video/Downsample.h>
+#include <lydia/video/VideoStream.h>
+
+#include <algorithm>
+
+namespace lydia::video {
+
+	VideoStream::VideoStream(Settings settings, FrameFunction done, VideoCodec::Factory factory)
+		: settings_(settings),
+		  done_(std::move(done)),
+		  factory_(std::move(factory)),
+		  switch_(settings.mode),
+		  epoch_(Clock::now()) {
+		if(!factory_ && VideoCodec::Available())
+			factory_ = &VideoCodec::Create;
+		failed_ = !factory_;
+
+		thread_ = std::thread(&VideoStream::ThreadEntry, this);
+	}
+
+	VideoStream::~VideoStream() {
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			stopping_ = true;
+		}
+		cond_.notify_one();
+		thread_.join();
+	}
+
+	VideoStream::Decision VideoStream::Update(const std::shared_ptr<const Framebuffer>& frame, const TileDiff& diff, Clock::time_point now) {
+		if(failed_.load(std::memory_order_acquire)) {
+			// Either there never was video mode, or the Refresh the switch gives after leaving it.
+			if(!switch_.InVideoMode())
+				return Decision::Rects;
+
+			switch_.Leave();
+			return switch_.Update(diff, now);
+		}
+
+		const bool entering = !switch_.InVideoMode();
+		const auto decision = switch_.Update(diff, now);
+		if(decision == Decision::Video)
+			Submit(frame, diff.DirtyTileCount() != 0, entering, now);
+
+		return decision;
+	}
+
+	bool VideoStream::Submit(const std::shared_ptr<const Framebuffer>& frame, bool changed, bool keyframe, Clock::time_point now) {
+		const auto interval = std::chrono::milliseconds(1000) / std::max<std::uint32_t>(settings_.framerate, 1);
+		changed |= stale_;
+
+		if(!keyframe && (!changed || now - last_submit_ < interval)) {
+			stale_ = changed;
+			return false;
+		}
+
+		last_submit_ = now;
+		stale_ = false;
+
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			pending_ = frame;
+			pending_timestamp_ = static_cast<std::uint32_t>(std::chrono::duration_cast<std::chrono::milliseconds>(now - epoch_).count());
+			pending_keyframe_ |= keyframe;
+		}
+		cond_.notify_one();
+		return true;
+	}
+
+	void VideoStream::RequestKeyframe() {
+		keyframe_requested_.store(true, std::memory_order_release);
+	}
+
+	bool VideoStream::InVideoMode() const {
+		return switch_.InVideoMode();
+	}
+
+	bool VideoStream::Failed() const {
+		return failed_.load(std::memory_order_acquire);
+	}
+
+	const VideoModeSwitch& VideoStream::GetModeSwitch() const {
+		return switch_;
+	}
+
+	void VideoStream::ThreadEntry() {
+		while(true) {
+			std::shared_ptr<const Framebuffer> frame;
+			std::uint32_t timestamp;
+			bool keyframe;
+			{
+				std::unique_lock<std::mutex> lock(mutex_);
+				cond_.wait(lock, [this] {
+					return stopping_ || pending_;
+				});
+
+				if(stopping_)
+					return;
+
+				frame = std::move(pending_);
+				timestamp = pending_timestamp_;
+				keyframe = pending_keyframe_;
+				pending_keyframe_ = false;
+			}
+
+			keyframe |= keyframe_requested_.exchange(false, std::memory_order_acq_rel);
+
+			if(!EncodeFrame(*frame, timestamp, keyframe)) {
+				codec_.reset();
+				failed_.store(true, std::memory_order_release);
+			}
+		}
+	}
+
+	bool VideoStream::EncodeFrame(const Framebuffer& source, std::uint32_t timestamp, bool keyframe) {
+		const auto* frame = &source;
+
+		// Fit the frame within the size limit, if it's over.
+		const auto max_width = settings_.max_width != 0 ? settings_.max_width : source.width;
+		const auto max_height = settings_.max_height != 0 ? settings_.max_height : source.height;
+		if(source.width > max_width || source.height > max_height) {
+			const auto scale = std::min(static_cast<double>(max_width) / source.width, static_cast<double>(max_height) / source.height);
+			scaled_.width = std::max<std::uint32_t>(static_cast<std::uint32_t>(source.width * scale), 1);
+			scaled_.height = std::max<std::uint32_t>(static_cast<std::uint32_t>(source.height * scale), 1);
+			scaled_.stride = scaled_.width * BytesPerPixel;
+			scaled_.data.resize(scaled_.stride * scaled_.height);
+
+			Downsample(source.View(), scaled_.data.data(), scaled_.width, scaled_.height, scaled_.stride);
+			frame = &scaled_;
+		}
+
+		if(!codec_ || codec_settings_.width != frame->width || codec_settings_.height != frame->height) {
+			codec_settings_.width = frame->width;
+			codec_settings_.height = frame->height;
+			codec_settings_.bitrate = settings_.bitrate;
+			codec_settings_.framerate = settings_.framerate;
+
+			codec_.reset();
+			codec_ = factory_(codec_settings_);
+			if(!codec_)
+				return false;
+
+			keyframe = true;
+		}
+
+		if(timestamp - last_keyframe_ >= settings_.keyframe_interval.count())
+			keyframe = true;
+
+		const std::size_t chroma_width = (frame->width + 1) / 2;
+		const std::size_t chroma_height = (frame->height + 1) / 2;
+		const std::size_t luma_size = static_cast<std::size_t>(frame->width) * frame->height;
+		const std::size_t chroma_size = chroma_width * chroma_height;
+		i420_.resize(luma_size + chroma_size * 2);
+
+		const narwhal::I420Planes planes {
+			i420_.data(), frame->width,
+			i420_.data() + luma_size, chroma_width,
+			i420_.data() + luma_size + chroma_size, chroma_width
+		};
+		narwhal::BgrxToI420(frame->data.data(), frame->stride, frame->width, frame->height, planes);
+
+		bool is_keyframe = false;
+		if(!codec_->Encode(planes, timestamp, keyframe, encoded_, is_keyframe))
+			return false;
+
+		// A keyframe the codec skipped (to keep to the bitrate) is still owed.
+		if(keyframe && !is_keyframe)
+			keyframe_requested_.store(true, std::memory_order_release);
+
+		if(encoded_.empty())
+			return true;
+
+		if(is_keyframe)
+			last_keyframe_ = timestamp;
+
+		messages::VideoFrameMessage message;
+		message.codec = codec_->GetCodec();
+		message.width = static_cast<std::uint16_t>(frame->width);
+		message.height = static_cast<std::uint16_t>(frame->height);
+		message.keyframe = is_keyframe;
+		message.timestamp = timestamp;
+		message.data.GetUnderlying().swap(encoded_);
+
+		binproto::BufferWriter writer(message.data.GetUnderlying().size() + 32);
+		message.header.Write(writer);
+		message.WritePayload(writer);
+
+		// Keep the buffer for the next frame.
+		encoded_.swap(message.data.GetUnderlying());
+
+		done_(std::make_shared<const std::vector<std::uint8_t>>(writer.Release()), is_keyframe);
+		return true;
+	}
+
+} // namespace lydia::video